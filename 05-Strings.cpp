@@ -157,4 +157,1086 @@ void stringFunctions() {  // (Listed alphabetically)
     // Note: There are more find() functions available that may be better suited for your needs.
 }
 
+/**************************
+    FAST NUMBER PARSING
+**************************/
+
+// stoi(), stod(), and stof() from the list above are easy to use, but they're slow in a hot loop:
+// 1. They take a std::string, so parsing part of a bigger string means making a copy first (substr).
+// 2. They throw an exception if the string isn't a number, and exceptions are very slow when thrown.
+// 3. They check the current "locale" (ex. whether the decimal point is '.' or ','), which costs time.
+/* C++17 added std::from_chars() in the <charconv> header, which has none of these problems. It reads from
+   a plain range of characters, never allocates, never throws, and ignores the locale. */
+// (from_chars() for floats needs a fairly new standard library, like GCC 11 or Visual Studio 2019.)
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+// Returns the number, or std::nullopt if "text" isn't EXACTLY one number (no spaces or extra characters).
+template <typename T>
+std::optional<T> parseNumber(std::string_view text) {
+    T value{};
+    std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) return std::nullopt;
+    return value;
+}
+
+// Now parsing can't crash the program, and we can check the result with an if statement:
+
+void parseExamples() {
+    std::optional<int> i = parseNumber<int>("42");        // i is 42
+    std::optional<double> d = parseNumber<double>("2.5"); // d is 2.5
+    std::optional<int> bad = parseNumber<int>("4x2");     // bad is empty (std::nullopt)
+    if (!bad) {
+        // Handle the error
+    }
+}
+
+// Parsing a whole column of integers (ex. from a CSV file) can go even faster.
+/* Normally we'd handle one digit at a time. But 8 characters fit in one 64-bit integer, so with some clever
+   math we can check and convert 8 digits at once. This is called SWAR: "SIMD within a register". */
+
+// Returns true if all 8 bytes in "chunk" are the characters '0' to '9'
+constexpr bool allEightAreDigits(std::uint64_t chunk) {
+    // '0'-'9' are 0x30-0x39. The top half of each byte must be 3, and adding 6 must not carry past 0x3F.
+    return (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+            == 0x3333333333333333);
+}
+
+// Turns 8 digit characters into their value. Each step combines neighbouring pairs: 8 digits become
+// 4 two-digit numbers, then 2 four-digit numbers, then 1 eight-digit number.
+constexpr std::uint32_t parseEightDigits(std::uint64_t chunk) {
+    chunk -= 0x3030303030303030;                                   // Characters to digit values
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FF;      // Pairs: "12" -> 12
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFF;    // Quads: 12, 34 -> 1234
+    return static_cast<std::uint32_t>(chunk * 10000 + (chunk >> 32)); // 1234, 5678 -> 12345678
+}
+// (This assumes a little-endian CPU, which is what x86 and almost all ARM machines are.)
+
+// Parses one integer that fills all of [p, end). Returns false if it isn't a valid integer (or is empty).
+inline bool parseIntField(const char* p, const char* end, std::vector<std::int64_t>& out) {
+    bool negative = (p < end && *p == '-');
+    const char* digits = p + negative;
+    std::size_t digitCount = end - digits;
+    if (digitCount == 0 || digitCount > 18) { // Too long to be sure it fits, so use the safe way
+        std::int64_t value;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc{} || result.ptr != end) return false;
+        out.push_back(value);
+        return true;
+    }
+    std::uint64_t value = 0;
+    while (end - digits >= 8) { // 8 digits at a time...
+        std::uint64_t chunk;
+        std::memcpy(&chunk, digits, 8); // memcpy is the safe way to read 8 unaligned bytes
+        if (!allEightAreDigits(chunk)) return false;
+        value = value * 100000000 + parseEightDigits(chunk);
+        digits += 8;
+    }
+    for (; digits < end; ++digits) { // ...then whatever is left, one at a time
+        unsigned digit = static_cast<unsigned char>(*digits) - '0';
+        if (digit > 9) return false;
+        value = value * 10 + digit;
+    }
+    out.push_back(negative ? -static_cast<std::int64_t>(value) : static_cast<std::int64_t>(value));
+    return true;
+}
+
+// Parses integers separated by "delimiter" (ex. ',' or '\n') and appends them to "out".
+// Returns false (and stops) at the first field that isn't a valid integer. Empty fields count as invalid,
+// so "1,,2" and "1,2," are both rejected. (An empty string is fine, it just has no fields.)
+inline bool parseIntColumn(std::string_view text, char delimiter, std::vector<std::int64_t>& out) {
+    if (text.empty()) return true;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (const char* fieldEnd = static_cast<const char*>(std::memchr(p, delimiter, end - p))) {
+        if (!parseIntField(p, fieldEnd, out)) return false;
+        p = fieldEnd + 1; // fieldEnd is before "end", so this is at most "end"
+    }
+    return parseIntField(p, end, out); // The last field has no delimiter after it
+}
+
+// Here's a benchmark against the sto* functions:
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// Every benchmark in this file uses this. It runs func() "repeats" times and returns how many milliseconds
+// that took in total.
+/* func should return something it computed, like a sum of its results. Storing that in a volatile variable
+   stops the compiler from deciding the work is never used and skipping it. */
+template <typename Func>
+double timeIt(Func func, std::size_t repeats = 1) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < repeats; ++i) {
+        volatile auto result = func();
+        (void)result;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void benchmarkNumberParsing() {
+    constexpr int count = 1'000'000;
+    std::mt19937 mt{42};
+    std::vector<std::string> intStrings, doubleStrings;
+    std::string column; // The same integers, separated by commas
+    for (int i = 0; i < count; ++i) {
+        intStrings.push_back(std::to_string(static_cast<int>(mt() % 2'000'000'000) - 1'000'000'000));
+        doubleStrings.push_back(std::to_string(mt() / 1000.0));
+        column += intStrings.back() + ',';
+    }
+    column.pop_back();
+
+    std::cout << "stoi:                " << timeIt([&] {
+        double sum = 0;
+        for (const std::string& s : intStrings) sum += std::stoi(s);
+        return sum;
+    }) << "ms\n";
+    std::cout << "parseNumber<int>:    " << timeIt([&] {
+        double sum = 0;
+        for (const std::string& s : intStrings) sum += *parseNumber<int>(s);
+        return sum;
+    }) << "ms\n";
+    std::cout << "parseIntColumn:      " << timeIt([&] {
+        std::vector<std::int64_t> values;
+        values.reserve(count);
+        parseIntColumn(column, ',', values);
+        double sum = 0;
+        for (std::int64_t v : values) sum += v;
+        return sum;
+    }) << "ms\n";
+    std::cout << "stod:                " << timeIt([&] {
+        double sum = 0;
+        for (const std::string& s : doubleStrings) sum += std::stod(s);
+        return sum;
+    }) << "ms\n";
+    std::cout << "parseNumber<double>: " << timeIt([&] {
+        double sum = 0;
+        for (const std::string& s : doubleStrings) sum += *parseNumber<double>(s);
+        return sum;
+    }) << "ms\n";
+}
+
+/*****************************
+    FAST NUMBER FORMATTING
+*****************************/
+
+// Going the other way, std::to_string(1) returns a brand new std::string every time it's called.
+/* A number is short enough to fit in the string's own small buffer (the "small string optimization"), so
+   that usually isn't an allocation. But when you're building a bigger piece of text (a line of a CSV file,
+   a log message...), each number still becomes a temporary string, which then gets copied into the result. */
+// Instead, we can write the characters straight into the buffer we're building, and reuse it every time.
+
+// For integers, the slow part is dividing by 10 for each digit. We can halve the number of divisions by
+// dividing by 100 instead, and looking up both digits of the remainder in a table:
+constexpr char digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+#include <type_traits>
+
+// Writes the digits of "value" starting at "out" and returns a pointer just past the last character written.
+// "out" needs room for 20 characters (the longest 64-bit number).
+inline char* formatDigits(char* out, std::uint64_t value) {
+    char temp[20];
+    char* p = temp + 20; // Digits come out last-to-first, so fill the temp buffer backwards
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100);
+        value /= 100;
+        p -= 2;
+        std::memcpy(p, digitPairs + pair * 2, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        std::memcpy(p, digitPairs + value * 2, 2);
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    std::size_t length = temp + 20 - p;
+    std::memcpy(out, p, length);
+    return out + length;
+}
+
+// Works for any integer type (int, unsigned, std::size_t, long long...) except bool.
+// Needs room for 20 characters, including the '-'.
+/* This is a template instead of separate int64_t and uint64_t versions, because with just those two,
+   formatInt(buffer, 5) doesn't compile: an int converts equally well to either one, so it's ambiguous. */
+template <typename Int, typename = std::enable_if_t<std::is_integral_v<Int> && !std::is_same_v<Int, bool>>>
+char* formatInt(char* out, Int value) {
+    if constexpr (std::is_signed_v<Int>) {
+        if (value < 0) {
+            *out++ = '-';
+            return formatDigits(out, 0 - static_cast<std::uint64_t>(value)); // Works even for the smallest int
+        }
+    }
+    return formatDigits(out, static_cast<std::uint64_t>(value));
+}
+
+/* For floating point numbers, std::to_chars() (from <charconv>) already does the hard part. Without a
+   format argument, it writes the SHORTEST text that reads back as the exact same double. For example, 0.1
+   gets written as "0.1" instead of "0.10000000000000001". */
+// "out" needs room for 24 characters.
+inline char* formatDouble(char* out, double value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+// If you'd rather not manage buffers yourself, a StringBuilder keeps one and reuses it.
+// clear() empties the string but keeps its memory, so after the first few uses it never allocates again.
+class StringBuilder {
+    std::string buffer;
+    std::size_t used = 0;
+
+    char* makeRoom(std::size_t bytes) {
+        // Grow by doubling, like std::vector does
+        if (buffer.size() - used < bytes) buffer.resize(std::max(buffer.size() * 2, used + bytes));
+        return buffer.data() + used;
+    }
+public:
+    StringBuilder& append(std::string_view text) {
+        std::memcpy(makeRoom(text.size()), text.data(), text.size());
+        used += text.size();
+        return *this;
+    }
+    StringBuilder& append(char c) {
+        *makeRoom(1) = c;
+        ++used;
+        return *this;
+    }
+    // Any integer type. A char still goes to append(char) above, since a non-template function wins a tie.
+    /* bool is an integer type too, but "1" isn't very readable, so it's written as a word instead (like
+       std::boolalpha). That has to happen in here: a separate append(bool) would also catch append("text"),
+       because a string literal converts to bool more easily than to std::string_view. */
+    template <typename Int, typename = std::enable_if_t<std::is_integral_v<Int>>>
+    StringBuilder& append(Int value) {
+        if constexpr (std::is_same_v<Int, bool>) {
+            return append(std::string_view(value ? "true" : "false"));
+        } else {
+            used = formatInt(makeRoom(20), value) - buffer.data();
+            return *this;
+        }
+    }
+    StringBuilder& append(double value) {
+        used = formatDouble(makeRoom(24), value) - buffer.data();
+        return *this;
+    }
+
+    // Only valid until the next append() or clear()
+    std::string_view view() const { return std::string_view(buffer.data(), used); }
+    void clear() { used = 0; }
+};
+
+void formatExamples() {
+    char buffer[24];
+    char* end = formatInt(buffer, -1234);
+    std::string_view text(buffer, end - buffer); // "-1234"
+
+    StringBuilder builder;
+    for (int i = 0; i < 1000; ++i) {
+        builder.clear(); // Reuses the same memory every time
+        builder.append("metric_").append(i).append('=').append(i * 0.25).append('\n');
+        // Do something with builder.view()
+    }
+}
+
+// Here's a benchmark against std::to_string():
+
+void benchmarkNumberFormatting() {
+    constexpr int count = 1'000'000;
+    std::mt19937 mt{42};
+    std::vector<std::int64_t> ints(count);
+    std::vector<double> doubles(count);
+    for (int i = 0; i < count; ++i) {
+        ints[i] = static_cast<std::int64_t>(mt()) - 2'000'000'000;
+        doubles[i] = mt() / 1000.0;
+    }
+
+    std::cout << "std::to_string(int):    " << timeIt([&] {
+        std::size_t total = 0;
+        for (std::int64_t v : ints) total += std::to_string(v).size();
+        return total;
+    }) << "ms\n";
+    std::cout << "formatInt:              " << timeIt([&] {
+        std::size_t total = 0;
+        char buffer[24];
+        for (std::int64_t v : ints) total += formatInt(buffer, v) - buffer;
+        return total;
+    }) << "ms\n";
+    std::cout << "std::to_string(double): " << timeIt([&] { // Note: to_string always prints 6 decimal places
+        std::size_t total = 0;
+        for (double v : doubles) total += std::to_string(v).size();
+        return total;
+    }) << "ms\n";
+    std::cout << "formatDouble:           " << timeIt([&] {
+        std::size_t total = 0;
+        char buffer[24];
+        for (double v : doubles) total += formatDouble(buffer, v) - buffer;
+        return total;
+    }) << "ms\n";
+    // The same "int,double" lines built the usual way (to_string's 6 decimal places make them a bit longer)
+    std::cout << "to_string + append:     " << timeIt([&] {
+        std::string line;
+        std::size_t total = 0;
+        for (int i = 0; i < count; ++i) {
+            line.clear();
+            line += std::to_string(ints[i]);
+            line += ',';
+            line += std::to_string(doubles[i]);
+            total += line.size();
+        }
+        return total;
+    }) << "ms\n";
+    std::cout << "StringBuilder:          " << timeIt([&] {
+        StringBuilder builder;
+        std::size_t total = 0;
+        for (int i = 0; i < count; ++i) {
+            builder.clear();
+            builder.append(ints[i]).append(',').append(doubles[i]);
+            total += builder.view().size();
+        }
+        return total;
+    }) << "ms\n";
+}
+
+/*************************
+    FAST STRING SEARCH
+*************************/
+
+// str.find() is fine for short strings. For scanning megabytes of text, we can do a lot better.
+/* Most modern CPUs have SIMD instructions, which do the same operation on many bytes at once. SSE2 works
+   on 16 bytes at a time, and AVX2 works on 32. Every 64-bit x86 CPU has SSE2, but only newer ones have
+   AVX2, so we check what the CPU supports when the program starts ("runtime dispatch"). */
+// Different strategies work best for different needle (the text we're looking for) lengths:
+/* 1. One character: compare 16/32 bytes against that character at once. That's exactly what memchr()
+      does, and the standard library's version is hand-tuned (unrolled, aligned loads...) to the point that
+      a simple SIMD loop of our own is SLOWER. So for one character we just call memchr(). */
+/* 2. Short needles: compare 16/32 positions against the needle's FIRST and LAST characters at once. Only
+      positions where both match get checked fully with memcmp(). This rules out almost everything fast. */
+/* 3. Long needles: the Boyer-Moore-Horspool algorithm. When a match fails, it uses a table to jump ahead
+      by up to the needle's whole length, so the longer the needle, the fewer bytes it even looks at.
+      Building the table costs about as much as scanning a few hundred bytes, so it's only worth it for
+      long haystacks (or if you build the searcher once and reuse it for many haystacks). */
+// (C++17 also has std::boyer_moore_horspool_searcher in <functional>, which works the same way.)
+
+#include <cstring>
+#include <string_view>
+
+// Boyer-Moore-Horspool. Build it once per needle, then search as many haystacks as you want.
+class HorspoolSearcher {
+    std::string_view needle;
+    std::size_t skip[256]; // How far we can jump based on the haystack character under the needle's end
+public:
+    explicit HorspoolSearcher(std::string_view needle) : needle(needle) {
+        for (std::size_t& s : skip) s = needle.size(); // A character not in the needle: skip all of it
+        for (std::size_t i = 0; i + 1 < needle.size(); ++i) {
+            skip[static_cast<unsigned char>(needle[i])] = needle.size() - 1 - i;
+        }
+    }
+
+    std::size_t find(std::string_view haystack) const {
+        std::size_t m = needle.size();
+        if (m == 0) return 0;
+        for (std::size_t pos = 0; pos + m <= haystack.size();) {
+            char last = haystack[pos + m - 1];
+            if (last == needle[m - 1] && std::memcmp(haystack.data() + pos, needle.data(), m - 1) == 0) {
+                return pos;
+            }
+            pos += skip[static_cast<unsigned char>(last)];
+        }
+        return std::string_view::npos;
+    }
+};
+
+// The SIMD versions use compiler-specific features, so they're only built with GCC or Clang on x86-64.
+// "__attribute__((target("avx2")))" lets one function use AVX2 without requiring it for the whole program.
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAS_SIMD_SEARCH 1
+
+// Both widths share the same logic, so each is a template over a tiny "Simd" struct.
+// GCC warns that passing AVX2 values between functions depends on compiler flags. These helpers all get
+// inlined into the target("avx2") functions below, so the warning doesn't apply.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+struct Sse2 {
+    using Vec = __m128i;
+    static constexpr std::size_t width = 16;
+    __attribute__((target("sse2"))) static Vec splat(char c) { return _mm_set1_epi8(c); }
+    __attribute__((target("sse2"))) static Vec load(const char* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    // Bit i is set if byte i of a equals byte i of b
+    __attribute__((target("sse2"))) static unsigned matches(Vec a, Vec b) {
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    }
+};
+
+struct Avx2 {
+    using Vec = __m256i;
+    static constexpr std::size_t width = 32;
+    __attribute__((target("avx2"))) static Vec splat(char c) { return _mm256_set1_epi8(c); }
+    __attribute__((target("avx2"))) static Vec load(const char* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static unsigned matches(Vec a, Vec b) {
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    }
+};
+
+template <typename Simd>
+__attribute__((always_inline)) inline std::size_t simdFindShort(std::string_view haystack,
+                                                                std::string_view needle) {
+    std::size_t m = needle.size(); // At least 2
+    typename Simd::Vec first = Simd::splat(needle.front());
+    typename Simd::Vec last = Simd::splat(needle.back());
+    std::size_t i = 0;
+    for (; i + m - 1 + Simd::width <= haystack.size(); i += Simd::width) {
+        // A candidate is any position where the first AND last characters line up
+        unsigned mask = Simd::matches(Simd::load(haystack.data() + i), first)
+                      & Simd::matches(Simd::load(haystack.data() + i + m - 1), last);
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (std::memcmp(haystack.data() + i + bit + 1, needle.data() + 1, m - 2) == 0) return i + bit;
+            mask &= mask - 1; // Clear the lowest set bit and check the next candidate
+        }
+    }
+    std::size_t rest = haystack.substr(i).find(needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+
+// The actual entry points. The "target" attribute has to be on the outer function too, so the compiler
+// is allowed to inline the AVX2 helpers into it.
+__attribute__((target("sse2"))) inline std::size_t findShortSse2(std::string_view h, std::string_view n) {
+    return simdFindShort<Sse2>(h, n);
+}
+__attribute__((target("avx2"))) inline std::size_t findShortAvx2(std::string_view h, std::string_view n) {
+    return simdFindShort<Avx2>(h, n);
+}
+#pragma GCC diagnostic pop
+#endif
+
+inline std::size_t fastFind(std::string_view haystack, char c) {
+    const void* found = std::memchr(haystack.data(), c, haystack.size());
+    return found ? static_cast<const char*>(found) - haystack.data() : std::string_view::npos;
+}
+
+// Picks the best version for this CPU. The check only happens once, the first time this is called.
+inline std::size_t fastFind(std::string_view haystack, std::string_view needle) {
+    if (needle.empty()) return 0;
+    if (needle.size() == 1) return fastFind(haystack, needle[0]);
+    if (needle.size() > 32) { // Long needles
+        // Below about 512 bytes, building the skip table takes longer than a plain find() (measured)
+        if (haystack.size() < 512) return haystack.find(needle);
+        return HorspoolSearcher(needle).find(haystack);
+    }
+#ifdef HAS_SIMD_SEARCH
+    static const auto impl = __builtin_cpu_supports("avx2") ? findShortAvx2 : findShortSse2;
+    return impl(haystack, needle);
+#else
+    return haystack.find(needle);
+#endif
+}
+
+// Here is a benchmark against std::string::find(), with the needle placed at the very end of the haystack:
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+void benchmarkStringSearch() {
+    std::mt19937 mt{42};
+    const std::string shortNeedle = "needle";
+    const std::string longNeedle = "a much longer needle that is over thirty-two characters";
+
+    for (std::size_t size : {64, 4096, 1 << 20, 64 << 20}) {
+        for (const std::string& needle : {std::string("#"), shortNeedle, longNeedle}) {
+            std::string haystack(size, ' ');
+            for (char& c : haystack) c = static_cast<char>('a' + mt() % 26);
+            haystack.replace(size - needle.size(), needle.size(), needle);
+
+            std::size_t repeats = std::max<std::size_t>(1, (256 << 20) / size); // ~256MB scanned per test
+            double gigabytes = static_cast<double>(size * repeats) / (1 << 30);
+            double stdSpeed = gigabytes / timeIt([&] { return haystack.find(needle); }, repeats) * 1000;
+            double fastSpeed = gigabytes / timeIt([&] { return fastFind(haystack, needle); }, repeats) * 1000;
+            std::cout << "haystack " << size << "B, needle " << needle.size() << "B: std::string::find "
+                      << stdSpeed << " GB/s, fastFind " << fastSpeed << " GB/s\n";
+        }
+    }
+}
+
+/************
+    ROPES
+************/
+
+// str.insert(), str.erase(), and str.replace() all have to shift every character after the edit.
+/* For a 10MB document, inserting one character near the start moves almost 10MB of memory. A text editor
+   doing thousands of edits per second can't afford that. */
+/* A ROPE stores the text as lots of small chunks arranged in a balanced tree. An edit only touches the
+   handful of chunks on the path from the root to the edit, so it takes O(log n) time instead of O(n). */
+/* Our rope's nodes are never modified after they're created. An edit builds a few new nodes and reuses all
+   the others. This means copying a Rope is instant (it just shares the same tree), which makes snapshots
+   (ex. for undo) basically free. */
+// The tree is kept balanced by giving each node a random "priority" (this kind of tree is called a treap).
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+class Rope {
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    struct Node {
+        NodePtr left, right;
+        std::string text;        // This node's chunk (it comes after everything in left, before right)
+        std::size_t length;      // Total characters in this whole subtree
+        std::uint32_t priority;  // Parents always have a higher priority than their children
+    };
+    static constexpr std::size_t maxChunk = 256;
+
+    NodePtr root;
+
+    static std::size_t lengthOf(const NodePtr& node) { return node ? node->length : 0; }
+
+    static NodePtr makeNode(NodePtr left, std::string text, NodePtr right, std::uint32_t priority) {
+        std::size_t length = lengthOf(left) + text.size() + lengthOf(right);
+        return std::make_shared<const Node>(
+            Node{std::move(left), std::move(right), std::move(text), length, priority});
+    }
+    static NodePtr makeLeaf(std::string_view text) {
+        thread_local std::mt19937 mt{std::random_device{}()};
+        return text.empty() ? nullptr : makeNode(nullptr, std::string(text), nullptr, mt());
+    }
+
+    // Joins two trees (everything in a comes before everything in b)
+    static NodePtr merge(const NodePtr& a, const NodePtr& b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) return makeNode(a->left, a->text, merge(a->right, b), a->priority);
+        return makeNode(merge(a, b->left), b->text, b->right, b->priority);
+    }
+
+    // Splits a tree into the first "pos" characters and the rest
+    static std::pair<NodePtr, NodePtr> split(const NodePtr& node, std::size_t pos) {
+        if (!node) return {nullptr, nullptr};
+        std::size_t leftLength = lengthOf(node->left);
+        if (pos <= leftLength) { // The cut is somewhere in the left subtree
+            auto [first, second] = split(node->left, pos);
+            return {first, makeNode(second, node->text, node->right, node->priority)};
+        }
+        pos -= leftLength;
+        if (pos >= node->text.size()) { // The cut is somewhere in the right subtree
+            auto [first, second] = split(node->right, pos - node->text.size());
+            return {makeNode(node->left, node->text, first, node->priority), second};
+        }
+        // The cut is inside this node's own chunk, so the chunk gets cut in two
+        std::string_view text = node->text;
+        return {merge(node->left, makeLeaf(text.substr(0, pos))),
+                merge(makeLeaf(text.substr(pos)), node->right)};
+    }
+
+    // Builds a tree out of any amount of text, in chunks of at most maxChunk characters
+    static NodePtr build(std::string_view text) {
+        NodePtr result;
+        for (std::size_t i = 0; i < text.size(); i += maxChunk) {
+            result = merge(result, makeLeaf(text.substr(i, maxChunk)));
+        }
+        return result;
+    }
+
+    void checkPosition(std::size_t pos) const {
+        if (pos > size()) throw std::out_of_range("Rope position out of range"); // Same as std::string
+    }
+
+    template <typename Func>
+    static void visitChunks(const NodePtr& node, Func& func) { // In order: left, this node, right
+        if (!node) return;
+        visitChunks(node->left, func);
+        func(std::string_view(node->text));
+        visitChunks(node->right, func);
+    }
+
+public:
+    static constexpr std::size_t npos = std::string::npos;
+
+    Rope() = default;
+    Rope(std::string_view text) : root(build(text)) {}
+    // Copying (Rope snapshot = rope;) shares the tree, so it's O(1) and the copies don't affect each other
+
+    std::size_t size() const { return lengthOf(root); }
+    std::size_t length() const { return size(); }
+    bool empty() const { return !root; }
+    void clear() { root = nullptr; }
+
+    // O(log n), unlike std::string's O(1), since we have to walk down the tree
+    char operator[](std::size_t pos) const {
+        const Node* node = root.get();
+        while (true) {
+            std::size_t leftLength = lengthOf(node->left);
+            if (pos < leftLength) { node = node->left.get(); continue; }
+            pos -= leftLength;
+            if (pos < node->text.size()) return node->text[pos];
+            pos -= node->text.size();
+            node = node->right.get();
+        }
+    }
+    char at(std::size_t pos) const {
+        if (pos >= size()) throw std::out_of_range("Rope::at");
+        return (*this)[pos];
+    }
+    char front() const { return (*this)[0]; }
+    char back() const { return (*this)[size() - 1]; }
+
+    Rope& insert(std::size_t pos, std::string_view text) {
+        checkPosition(pos);
+        auto [before, after] = split(root, pos);
+        root = merge(merge(before, build(text)), after);
+        return *this;
+    }
+    Rope& erase(std::size_t pos = 0, std::size_t count = npos) {
+        checkPosition(pos);
+        auto [before, rest] = split(root, pos);
+        auto [removed, after] = split(rest, std::min(count, size() - pos));
+        root = merge(before, after);
+        return *this;
+    }
+    Rope& replace(std::size_t pos, std::size_t count, std::string_view text) {
+        checkPosition(pos);
+        auto [before, rest] = split(root, pos);
+        auto [removed, after] = split(rest, std::min(count, size() - pos));
+        root = merge(merge(before, build(text)), after);
+        return *this;
+    }
+    Rope& append(std::string_view text) { root = merge(root, build(text)); return *this; }
+    Rope& append(const Rope& other) { root = merge(root, other.root); return *this; } // O(log n) too!
+    void push_back(char c) { append(std::string_view(&c, 1)); }
+    void pop_back() { erase(size() - 1, 1); }
+
+    // Calls func(std::string_view) on each chunk in order. Lets you process the text without copying it.
+    template <typename Func>
+    void forEachChunk(Func func) const { visitChunks(root, func); }
+
+    // Copies part of the rope into a normal string
+    std::string substr(std::size_t pos = 0, std::size_t count = npos) const {
+        checkPosition(pos);
+        auto [before, rest] = split(root, pos);
+        auto [middle, after] = split(rest, std::min(count, size() - pos));
+        std::string result;
+        result.reserve(lengthOf(middle));
+        auto appendChunk = [&](std::string_view chunk) { result.append(chunk); };
+        visitChunks(middle, appendChunk);
+        return result;
+    }
+    // Copies the whole rope into one contiguous string (O(n), so only do this when you need to)
+    std::string str() const { return substr(); }
+};
+
+// Here are the edits from stringFunctions() above, done with a Rope:
+
+void ropeExamples() {
+    Rope rope("Hello world");
+    Rope snapshot = rope;             // Instant, no matter how big the rope is
+    rope.insert(6, "cruel ");         // "Hello cruel world"
+    rope.erase(5, 6);                 // "Hello world"
+    rope.replace(0, 5, "Goodbye");    // "Goodbye world"
+    std::string text = rope.str();    // "Goodbye world"
+    std::string old = snapshot.str(); // Still "Hello world"
+}
+
+// Downsides: reading a single character is O(log n) instead of O(1), and each node has some memory
+// overhead. Lots of single-character edits leave lots of tiny chunks behind, so if that's your workload,
+// you may want to occasionally rebuild the rope with Rope(rope.str()).
+
+/*******************************
+    SPLITTING WITHOUT COPIES
+*******************************/
+
+// A common way to split a line into fields is to find() each delimiter and substr() out the piece.
+// But substr() returns a brand new std::string, so every field costs an allocation and a copy.
+/* Since the fields are already sitting in the original string, we can just hand out std::string_views that
+   point at them instead. Splitting a whole line then doesn't allocate anything. */
+/* Below is a "lazy" range: it doesn't split anything up front. It finds the next delimiter each time the
+   for loop asks for the next field (using fastFind() from above, so 16-32 bytes get checked at once). */
+/* The iterator has the usual member types, so standard algorithms (std::distance, std::vector's constructor
+   ...) work with it. It's an INPUT iterator though: it can only be walked forward once, and two iterators
+   only compare equal if both are finished or both aren't, which is all that "!= end()" needs. */
+
+#include <cstddef>
+#include <iterator>
+
+class Split {
+    std::string_view text;
+    char delimiter;
+public:
+    Split(std::string_view text, char delimiter) : text(text), delimiter(delimiter) {}
+
+    class iterator {
+        std::string_view rest;   // Everything after the current field
+        std::string_view field;  // The current field
+        char delimiter = 0;
+        bool done = true;
+
+        void advance() {
+            if (!rest.data()) { done = true; return; } // No more delimiters were found last time
+            std::size_t pos = fastFind(rest, delimiter);
+            if (pos == std::string_view::npos) {
+                field = rest;
+                rest = std::string_view(); // Marks that this was the last field
+            } else {
+                field = rest.substr(0, pos);
+                rest = rest.substr(pos + 1);
+            }
+        }
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void; // There's no operator->, since a string_view is handed out by value
+        using reference = std::string_view;
+
+        iterator() = default; // The "end" iterator
+        iterator(std::string_view text, char delimiter) : rest(text), delimiter(delimiter), done(text.empty()) {
+            if (!done) advance();
+        }
+        std::string_view operator*() const { return field; }
+        iterator& operator++() { advance(); return *this; }
+        iterator operator++(int) {
+            iterator old = *this;
+            advance();
+            return old;
+        }
+        // Only ever compared against end(), so we only need to check whether we're finished
+        bool operator!=(const iterator& other) const { return done != other.done; }
+        bool operator==(const iterator& other) const { return done == other.done; }
+    };
+
+    iterator begin() const { return iterator(text, delimiter); }
+    iterator end() const { return iterator(); }
+};
+
+// Note that an empty string has no fields, but ",," has three (empty) fields, just like a CSV file would.
+
+void splitExample() {
+    std::string_view csvLine = "Ben,Benson,32";
+    for (std::string_view field : Split(csvLine, ',')) {
+        // field is "Ben", then "Benson", then "32". Nothing was copied.
+    }
+}
+
+// Real CSV files have one complication: a field can be put in quotes so that it can contain commas.
+// A quote inside a quoted field is written twice. For example: "Hello, ""world""" means Hello, "world"
+/* We still don't want to copy anything, so a CsvField gives you the raw text between the quotes, and only
+   builds a new string (with the doubled quotes fixed) if you ask for one with unescape(). */
+
+struct CsvField {
+    std::string_view raw;          // The text, without the surrounding quotes
+    bool hasEscapedQuotes = false; // True if raw contains "" that should become "
+
+    std::string unescape() const {
+        std::string result;
+        result.reserve(raw.size());
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            result.push_back(raw[i]);
+            if (raw[i] == '"' && hasEscapedQuotes) ++i; // Skip the second quote of each pair
+        }
+        return result;
+    }
+};
+
+class CsvSplit {
+    std::string_view text;
+    char delimiter;
+public:
+    CsvSplit(std::string_view text, char delimiter = ',') : text(text), delimiter(delimiter) {}
+
+    class iterator {
+        std::string_view rest;
+        CsvField field;
+        char delimiter = ',';
+        bool done = true;
+        bool sawDelimiter = false; // If the last field ended in a delimiter, there's one more (maybe empty)
+
+        void advance() {
+            if (rest.empty() && !sawDelimiter) { done = true; return; }
+            field = CsvField{};
+            if (!rest.empty() && rest.front() == '"') {
+                // Quoted field: find the closing quote, skipping over doubled quotes
+                std::size_t pos = 1;
+                while (true) {
+                    std::size_t quote = fastFind(rest.substr(pos), '"');
+                    if (quote == std::string_view::npos) { pos = rest.size(); break; } // No closing quote
+                    pos += quote;
+                    if (pos + 1 >= rest.size() || rest[pos + 1] != '"') break; // Found the closing quote
+                    field.hasEscapedQuotes = true;
+                    pos += 2;
+                }
+                field.raw = rest.substr(1, pos - 1);
+                rest = rest.substr(std::min(pos + 1, rest.size()));
+                // Skip to the delimiter (anything between the closing quote and the delimiter is ignored)
+                std::size_t next = fastFind(rest, delimiter);
+                sawDelimiter = next != std::string_view::npos;
+                rest = sawDelimiter ? rest.substr(next + 1) : std::string_view();
+            } else {
+                std::size_t next = fastFind(rest, delimiter);
+                sawDelimiter = next != std::string_view::npos;
+                field.raw = rest.substr(0, next);
+                rest = sawDelimiter ? rest.substr(next + 1) : std::string_view();
+            }
+        }
+    public:
+        // An input iterator, just like Split::iterator
+        using iterator_category = std::input_iterator_tag;
+        using value_type = CsvField;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const CsvField*;
+        using reference = const CsvField&;
+
+        iterator() = default;
+        iterator(std::string_view text, char delimiter) : rest(text), delimiter(delimiter), done(text.empty()) {
+            if (!done) advance();
+        }
+        const CsvField& operator*() const { return field; }
+        const CsvField* operator->() const { return &field; }
+        iterator& operator++() { advance(); return *this; }
+        iterator operator++(int) {
+            iterator old = *this;
+            advance();
+            return old;
+        }
+        bool operator!=(const iterator& other) const { return done != other.done; }
+        bool operator==(const iterator& other) const { return done == other.done; }
+    };
+
+    iterator begin() const { return iterator(text, delimiter); }
+    iterator end() const { return iterator(); }
+};
+
+void csvExample() {
+    std::string_view csvLine = R"(42,"Hello, ""world""",end)";
+    for (const CsvField& field : CsvSplit(csvLine)) {
+        // field.raw is: 42, then Hello, ""world"", then end
+        // field.unescape() would give Hello, "world" for the second one (this one does allocate)
+    }
+}
+
+/************
+    UTF-8
+************/
+
+// So far we've treated strings as plain bytes, where one char is one character.
+/* That's only true for ASCII (English letters, digits, punctuation). Everything else, like é, 中, or 😀,
+   is written in UTF-8 as 2 to 4 bytes. The first byte says how many bytes the character has, and the
+   others ("continuation bytes") all look like 10xxxxxx in binary. */
+// Each character's number (its "code point") goes from 0 to 0x10FFFF.
+/* Text from outside your program (files, the network, users) might not be valid UTF-8 at all, so it
+   should be checked before you trust it. Some byte sequences are never allowed:
+   - a continuation byte with nothing in front of it, or a first byte missing its continuation bytes
+   - "overlong" encodings (using more bytes than needed, ex. writing '/' as 2 bytes to sneak past a filter)
+   - code points 0xD800-0xDFFF (reserved for UTF-16) and anything above 0x10FFFF */
+
+/* Most real text is mostly ASCII, so the functions below check 16 bytes at a time with SSE2. If none of
+   them have the top bit set, they are all ASCII and can be handled in one go. Only blocks that contain
+   non-ASCII bytes go through the slower one-character-at-a-time path. */
+// (Libraries like simdutf go further and validate non-ASCII text with SIMD too, but that's a lot more code.)
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Decodes one character starting at p, and moves p past it. Returns false if the bytes aren't valid.
+inline bool decodeUtf8(const unsigned char*& p, const unsigned char* end, char32_t& codePoint) {
+    unsigned char first = *p;
+    if (first < 0x80) { codePoint = first; ++p; return true; }
+
+    int length;
+    char32_t minimum; // The smallest code point that actually needs this many bytes (anything less is overlong)
+    if ((first & 0xE0) == 0xC0) { length = 2; codePoint = first & 0x1F; minimum = 0x80; }
+    else if ((first & 0xF0) == 0xE0) { length = 3; codePoint = first & 0x0F; minimum = 0x800; }
+    else if ((first & 0xF8) == 0xF0) { length = 4; codePoint = first & 0x07; minimum = 0x10000; }
+    else return false; // A continuation byte (or 0xF8-0xFF) can't start a character
+
+    if (end - p < length) return false; // Cut off
+    for (int i = 1; i < length; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return false; // Not a continuation byte
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+    if (codePoint < minimum || codePoint > 0x10FFFF) return false;
+    if (codePoint >= 0xD800 && codePoint <= 0xDFFF) return false;
+    p += length;
+    return true;
+}
+
+// How many of the next bytes (up to 16) are ASCII
+inline std::size_t asciiPrefix16(const unsigned char* p, const unsigned char* end) {
+#ifdef __SSE2__
+    if (end - p >= 16) {
+        // movemask collects the top bit of every byte. The top bit is only set on non-ASCII bytes.
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return mask ? __builtin_ctz(mask) : 16;
+    }
+#endif
+    std::size_t count = 0;
+    while (p + count < end && count < 16 && p[count] < 0x80) ++count;
+    return count;
+}
+
+inline bool isValidUtf8(std::string_view text) {
+    auto p = reinterpret_cast<const unsigned char*>(text.data());
+    auto end = p + text.size();
+    while (p < end) {
+        std::size_t ascii = asciiPrefix16(p, end);
+        p += ascii;
+        if (ascii == 16 || p == end) continue;
+        char32_t ignored;
+        if (!decodeUtf8(p, end, ignored)) return false;
+    }
+    return true;
+}
+
+// Counts characters (not bytes) in VALID UTF-8. This is just the number of bytes that aren't
+// continuation bytes, which SIMD can count 16 at a time.
+inline std::size_t countCodePoints(std::string_view text) {
+    std::size_t count = 0, i = 0;
+#ifdef __SSE2__
+    // As signed chars, continuation bytes (0x80-0xBF) are -128 to -65. Everything else is greater.
+    const __m128i limit = _mm_set1_epi8(-65);
+    for (; i + 16 <= text.size(); i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, limit)));
+    }
+#endif
+    for (; i < text.size(); ++i) count += (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80;
+    return count;
+}
+
+// Converts UTF-8 to UTF-32 (one char32_t per character).
+// Returns false (and leaves "out" empty) if the input isn't valid UTF-8.
+inline bool utf8ToUtf32(std::string_view text, std::u32string& out) {
+    out.resize(text.size()); // There can't be more characters than bytes
+    char32_t* dest = out.data();
+    auto p = reinterpret_cast<const unsigned char*>(text.data());
+    auto end = p + text.size();
+    while (p < end) {
+#ifdef __SSE2__
+        if (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(chunk) == 0) { // All ASCII: widen each byte to 4 bytes by adding zeros
+                __m128i zero = _mm_setzero_si128();
+                __m128i low = _mm_unpacklo_epi8(chunk, zero), high = _mm_unpackhi_epi8(chunk, zero);
+                auto d = reinterpret_cast<__m128i*>(dest);
+                _mm_storeu_si128(d + 0, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(d + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(d + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(d + 3, _mm_unpackhi_epi16(high, zero));
+                p += 16;
+                dest += 16;
+                continue;
+            }
+        }
+#endif
+        if (!decodeUtf8(p, end, *dest++)) {
+            out.clear(); // Don't leave the half-converted text (and the unused space after it) behind
+            return false;
+        }
+    }
+    out.resize(dest - out.data());
+    return true;
+}
+
+// Converts UTF-8 to UTF-16 (what Windows and Java use). Characters above 0xFFFF don't fit in one
+// char16_t, so they're stored as two ("a surrogate pair"). Like utf8ToUtf32(), it empties "out" on bad input.
+inline bool utf8ToUtf16(std::string_view text, std::u16string& out) {
+    out.resize(text.size()); // UTF-16 never needs more units than UTF-8 has bytes
+    char16_t* dest = out.data();
+    auto p = reinterpret_cast<const unsigned char*>(text.data());
+    auto end = p + text.size();
+    while (p < end) {
+#ifdef __SSE2__
+        if (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(chunk) == 0) { // All ASCII: widen each byte to 2 bytes
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi8(chunk, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), _mm_unpackhi_epi8(chunk, zero));
+                p += 16;
+                dest += 16;
+                continue;
+            }
+        }
+#endif
+        char32_t codePoint;
+        if (!decodeUtf8(p, end, codePoint)) {
+            out.clear();
+            return false;
+        }
+        if (codePoint < 0x10000) {
+            *dest++ = static_cast<char16_t>(codePoint);
+        } else {
+            codePoint -= 0x10000;
+            *dest++ = static_cast<char16_t>(0xD800 + (codePoint >> 10));   // High surrogate
+            *dest++ = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)); // Low surrogate
+        }
+    }
+    out.resize(dest - out.data());
+    return true;
+}
+
+void utf8Examples() {
+    std::string_view text = "Héllo, 世界";
+    bool valid = isValidUtf8(text);            // true
+    std::size_t bytes = text.size();           // 14
+    std::size_t chars = countCodePoints(text); // 9
+
+    std::u32string utf32;
+    std::u16string utf16;
+    utf8ToUtf32(text, utf32); // utf32.size() is 9
+    utf8ToUtf16(text, utf16); // utf16.size() is 9 too (none of these need a surrogate pair)
+}
+
+// And a throughput benchmark, on mostly-ASCII text and on text that's all 3-byte characters:
+
+void benchmarkUtf8() {
+    std::string ascii, mixed, cjk;
+    for (int i = 0; i < 1'000'000; ++i) {
+        ascii += "Plain ASCII text. ";
+        mixed += (i % 8 == 0) ? "Café ünïcödé! " : "Plain ASCII text. ";
+        cjk += "中文字符";
+    }
+
+    // The output strings are reused, like a real program converting text over and over would do. Otherwise
+    // we'd be timing the memory allocation too.
+    std::u32string out32;
+    std::u16string out16;
+    for (const std::string* text : {&ascii, &mixed, &cjk}) {
+        const char* label = text == &ascii ? "ascii" : text == &mixed ? "mixed" : "cjk";
+        std::cout << label << ":\n";
+        const std::string& t = *text;
+        auto print = [&](const char* name, double ms) {
+            std::cout << name << t.size() / (ms / 1000) / (1 << 30) << " GB/s\n";
+        };
+        print("  isValidUtf8:     ", timeIt([&] { return isValidUtf8(t); }));
+        print("  countCodePoints: ", timeIt([&] { return countCodePoints(t); }));
+        utf8ToUtf32(t, out32); // Untimed first run, so the output strings are already big enough
+        utf8ToUtf16(t, out16);
+        print("  utf8ToUtf32:     ", timeIt([&] {
+            utf8ToUtf32(t, out32);
+            return out32.size();
+        }));
+        print("  utf8ToUtf16:     ", timeIt([&] {
+            utf8ToUtf16(t, out16);
+            return out16.size();
+        }));
+    }
+}
+
 #include "fakeheader.h"
\ No newline at end of file
@@ -40,4 +40,343 @@ std::cin >> input;  // Sets the value of "input" to the characters the user type
 // std::cin.eof() returns true if the entire input stream was extracted.
 // std::cin.peek() returns the next character in the input stream without extracting it.
 
+/**************************
+    FAST CONSOLE OUTPUT
+**************************/
+
+// For printing a few lines, std::cout is perfectly fine. For printing millions of lines, it's slow:
+/* 1. By default, std::cout is "synchronized" with C's printf(), so you can mix the two and the output
+      still comes out in the right order. To make that work, many standard libraries basically turn off
+      std::cout's own buffering, so every << ends up as a separate trip into the C library. */
+// 2. Every << goes through formatting machinery (locales, stream state checks) even for a single number.
+// 3. std::endl flushes every single line, which means one system call per line. (See above.)
+
+// The easiest fix for #1 is to turn the synchronization off at the start of main():
+
+#include <ios>
+
+void fasterCout() {
+    std::ios::sync_with_stdio(false); // std::cout gets its own buffer back
+    std::cin.tie(nullptr);            // Don't flush std::cout every time std::cin is used
+}
+
+// The catch: after sync_with_stdio(false), NEVER mix std::cout with printf()/puts() (or std::cin with
+// scanf()). They each have their own buffer now, so the output can come out in a jumbled order.
+// Also make sure to call it before ANY input or output happens, or the result is implementation-defined.
+
+/* For even more speed, we can skip iostreams entirely. ConsoleWriter collects output in one big buffer
+   and writes it to the console with a single write() call when it fills up, or when you call flush(). */
+// Numbers are formatted with std::to_chars(), which is much simpler than what << does.
+// (write() comes from <unistd.h>, which exists on Linux and macOS. On Windows, use _write() from <io.h>.)
+
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+class ConsoleWriter {
+    std::vector<char> buffer; // Its size never changes, so buffer.size() is how much fits
+    std::size_t used = 0;
+    int fd;
+
+    void makeRoom(std::size_t bytes) {
+        if (buffer.size() - used < bytes) flush(); // Size-triggered flush
+    }
+public:
+    // fd 1 is standard output ("stdout"), 2 is standard error ("stderr")
+    explicit ConsoleWriter(std::size_t capacity = 1 << 16, int fd = 1)
+        : buffer(capacity < 64 ? 64 : capacity), fd(fd) {} // Always room for a formatted number
+    ~ConsoleWriter() { flush(); } // Don't lose whatever is still in the buffer
+    // A copy would write the same unflushed output twice
+    ConsoleWriter(const ConsoleWriter&) = delete;
+    ConsoleWriter& operator=(const ConsoleWriter&) = delete;
+
+    // Explicit flush. Call this before waiting for user input, so they can see the prompt!
+    void flush() {
+        std::size_t done = 0;
+        while (done < used) {
+            ssize_t written = ::write(fd, buffer.data() + done, used - done);
+            if (written <= 0) break; // The console went away (ex. the pipe was closed). Nothing else to do.
+            done += static_cast<std::size_t>(written);
+        }
+        used = 0;
+    }
+
+    ConsoleWriter& operator<<(std::string_view text) {
+        if (text.size() > buffer.size()) { // Too big to ever fit: send it directly
+            flush();
+            for (std::size_t done = 0; done < text.size();) {
+                ssize_t written = ::write(fd, text.data() + done, text.size() - done);
+                if (written <= 0) break;
+                done += static_cast<std::size_t>(written);
+            }
+            return *this;
+        }
+        makeRoom(text.size());
+        std::memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+        return *this;
+    }
+    ConsoleWriter& operator<<(char c) {
+        makeRoom(1);
+        buffer[used++] = c;
+        return *this;
+    }
+    ConsoleWriter& operator<<(const char* text) { return *this << std::string_view(text); }
+
+    template <typename Number, typename = std::enable_if_t<std::is_arithmetic_v<Number>>>
+    ConsoleWriter& operator<<(Number value) {
+        if constexpr (std::is_same_v<Number, bool>) {
+            // Words, for the same reasons as in StringBuilder::append() in "Strings"
+            return *this << std::string_view(value ? "true" : "false");
+        } else {
+            makeRoom(32);
+            char* end = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr;
+            used = end - buffer.data();
+            return *this;
+        }
+    }
+};
+
+// It works just like std::cout:
+
+void consoleWriterExample() {
+    ConsoleWriter out;
+    out << "Newline\n";
+    for (int i = 0; i < 10; ++i) out << "Line " << i << '\n';
+    out.flush(); // Or let the destructor do it
+}
+
+// Here is a benchmark. Run it with the output sent somewhere other than the screen, since drawing text on
+// the screen is slower than all of these: "./program > /dev/null" (or "> NUL" on Windows).
+// The times are printed to std::cerr, so you'll still see them.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// Both benchmarks in this file use this. Returns how many milliseconds func() took to run.
+template <typename Func>
+double timeIt(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void benchmarkConsoleOutput(int lines = 10'000'000) {
+    // The raw write() row prints fewer lines, so every row is shown as time per line
+    auto perLine = [](double ms, int count) { return ms * 1'000'000 / count; };
+    std::cerr << "printf:                       " << perLine(timeIt([&] {
+        for (int i = 0; i < lines; ++i) std::printf("Line %d\n", i);
+        std::fflush(stdout);
+    }), lines) << "ns/line\n";
+    std::cerr << "std::cout << (synced):        " << perLine(timeIt([&] {
+        for (int i = 0; i < lines; ++i) std::cout << "Line " << i << '\n';
+        std::cout.flush();
+    }), lines) << "ns/line\n";
+    std::cerr << "ConsoleWriter:                " << perLine(timeIt([&] {
+        ConsoleWriter out(1 << 20);
+        for (int i = 0; i < lines; ++i) out << "Line " << i << '\n';
+    }), lines) << "ns/line\n";
+    // What happens with no buffering at all (on 100x fewer lines, or this would take forever)
+    int rawLines = lines / 100;
+    std::cerr << "raw write() per line:         " << perLine(timeIt([&] {
+        for (int i = 0; i < rawLines; ++i) {
+            char line[32];
+            std::memcpy(line, "Line ", 5);
+            char* end = std::to_chars(line + 5, line + 31, i).ptr;
+            *end++ = '\n';
+            for (char* p = line; p < end;) { // write() may write less than we asked for
+                ssize_t written = ::write(1, p, end - p);
+                if (written <= 0) return;
+                p += written;
+            }
+        }
+    }), rawLines) << "ns/line\n";
+
+    // Technically this is too late (output already happened), which makes the result implementation-defined.
+    // GCC, Clang, and MSVC all handle it fine, and everything above was flushed first.
+    std::ios::sync_with_stdio(false);
+    std::cerr << "std::cout << (unsynced):      " << perLine(timeIt([&] {
+        for (int i = 0; i < lines; ++i) std::cout << "Line " << i << '\n';
+        std::cout.flush();
+    }), lines) << "ns/line\n";
+}
+
+/************************
+    FAST CONSOLE INPUT
+************************/
+
+// std::cin >> has the same problems as std::cout <<, just in reverse.
+/* It reads one token at a time, checks the stream state, consults the locale to figure out what a digit
+   is, and (when synced with stdio) can end up asking the C library for input one character at a time. */
+// For a program that reads millions of numbers, that adds up. fasterCout() above helps std::cin too.
+/* For the fastest option, Scanner reads standard input in big blocks (64KB at a time) into its own buffer,
+   then picks the numbers out of that buffer directly with std::from_chars(). */
+
+#include <cctype>
+#include <cerrno>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+class Scanner {
+    std::vector<char> buffer;
+    std::size_t start = 0, end = 0; // The unread data is buffer[start, end)
+    int fd;
+    bool eof = false;
+
+    // Reads another block, keeping any unread data. Returns false if there was nothing left to read.
+    bool refill() {
+        if (eof) return false;
+        std::memmove(buffer.data(), buffer.data() + start, end - start);
+        end -= start;
+        start = 0;
+        if (end == buffer.size()) buffer.resize(buffer.size() * 2); // A single token bigger than the buffer
+        ssize_t got;
+        do {
+            got = ::read(fd, buffer.data() + end, buffer.size() - end);
+        } while (got < 0 && errno == EINTR); // Interrupted by a signal before anything arrived: just try again
+        if (got <= 0) { eof = true; return false; } // The end of the input, or a real error
+        end += static_cast<std::size_t>(got);
+        return true;
+    }
+
+    // Skips whitespace, then returns the next token (everything up to the next whitespace).
+    // The token is only valid until the next call to any Scanner function.
+    std::string_view nextToken() {
+        while (true) {
+            while (start < end && std::isspace(static_cast<unsigned char>(buffer[start]))) ++start;
+            if (start < end || !refill()) break;
+        }
+        std::size_t tokenEnd = start;
+        while (true) {
+            while (tokenEnd < end && !std::isspace(static_cast<unsigned char>(buffer[tokenEnd]))) ++tokenEnd;
+            // If we hit the end of the buffer, the token might continue in the next block
+            if (tokenEnd < end) break;
+            std::size_t offset = tokenEnd - start;
+            bool more = refill();
+            tokenEnd = start + offset; // refill() moved everything to the front of the buffer (even at the end)
+            if (!more) break;
+        }
+        std::string_view token(buffer.data() + start, tokenEnd - start);
+        start = tokenEnd;
+        return token;
+    }
+
+    template <typename T>
+    bool readNumber(T& value) {
+        std::string_view token = nextToken();
+        if (token.empty()) return false;
+        T parsed{};
+        std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), parsed);
+        if (result.ec != std::errc{} || result.ptr != token.data() + token.size()) return false; // ex. "12abc"
+        value = parsed; // Only touch value on success
+        return true;
+    }
+
+public:
+    // fd 0 is standard input ("stdin")
+    explicit Scanner(int fd = 0, std::size_t bufferSize = 1 << 16) : buffer(bufferSize), fd(fd) {}
+
+    // Each of these returns false at the end of the input, or if the next token isn't the right type.
+    // Either way, the token is used up: a bad token is skipped, not left there for the next read.
+    // (std::cin does the opposite. It leaves the bad input in place and refuses to read anything else.)
+    bool read(int& value) { return readNumber(value); }
+    bool read(long long& value) { return readNumber(value); }
+    bool read(double& value) { return readNumber(value); }
+    // The token points into the Scanner's buffer, so it's only valid until the next read. Copy it into a
+    // std::string if you need to keep it.
+    bool read(std::string_view& token) {
+        token = nextToken();
+        return !token.empty();
+    }
+
+    // Reads integers into out[0], out[1], ... until out is full or the input runs out.
+    // Returns how many were read.
+    std::size_t readAllInts(int* out, std::size_t count) {
+        std::size_t i = 0;
+        while (i < count && read(out[i])) ++i;
+        return i;
+    }
+#if __cplusplus >= 202002L
+    std::size_t readAllInts(std::span<int> out) { return readAllInts(out.data(), out.size()); } // C++20
+#endif
+};
+
+// Unlike std::cin, there's no way to "unread" something, and the Scanner keeps data in its own buffer.
+// So don't mix a Scanner with std::cin or scanf() on the same input.
+
+void scannerExample() {
+    Scanner in;
+    int count = 0;
+    if (!in.read(count) || count < 0) return; // Same as if (!(std::cin >> count)), plus a sanity check
+    std::vector<int> numbers(count);
+    std::size_t got = in.readAllInts(numbers.data(), numbers.size());
+    numbers.resize(got); // In case the input had fewer numbers than it promised
+}
+
+// Here's a benchmark. It writes a file full of numbers, then reads it back in as standard input with each
+// method. (freopen() swaps out what stdin is connected to.)
+
+#include <fcntl.h>
+
+void benchmarkConsoleInput(const char* path = "numbers.txt", int count = 10'000'000) {
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Couldn't create " << path << ": " << std::strerror(errno) << '\n';
+        return;
+    }
+    {
+        ConsoleWriter file(1 << 20, fd); // ConsoleWriter can write to any file descriptor, not just the console
+        for (int i = 0; i < count; ++i) file << i * 7 - 1'000'000 << (i % 10 == 9 ? '\n' : ' ');
+    } // The destructor flushes everything before we close the file
+    ::close(fd);
+
+    long long sum = 0; // Printed after each time, to show that every method read the same numbers
+    auto startOver = [&] { // Start reading the file from the beginning again. Returns false if we can't.
+        sum = 0;
+        std::cin.clear();
+        if (std::freopen(path, "r", stdin)) return true;
+        std::cerr << "Couldn't reopen " << path << ": " << std::strerror(errno) << '\n';
+        return false;
+    };
+
+    if (startOver()) {
+        std::cerr << "scanf:                     " << timeIt([&] {
+            int value;
+            while (std::scanf("%d", &value) == 1) sum += value;
+        }) << "ms (sum " << sum << ")\n"; // (Since C++17, << runs left to right, so sum is read after timeIt())
+    }
+    if (startOver()) {
+        std::cerr << "std::cin >> (synced):      " << timeIt([&] {
+            int value;
+            while (std::cin >> value) sum += value;
+        }) << "ms (sum " << sum << ")\n";
+    }
+    if (startOver()) {
+        std::cerr << "Scanner::readAllInts:      " << timeIt([&] {
+            std::vector<int> values(count);
+            Scanner in;
+            std::size_t got = in.readAllInts(values.data(), values.size());
+            for (std::size_t i = 0; i < got; ++i) sum += values[i];
+        }) << "ms (sum " << sum << ")\n";
+    }
+
+    std::ios::sync_with_stdio(false); // Same caveat as in benchmarkConsoleOutput()
+    if (startOver()) {
+        std::cerr << "std::cin >> (unsynced):    " << timeIt([&] {
+            int value;
+            while (std::cin >> value) sum += value;
+        }) << "ms (sum " << sum << ")\n";
+    }
+
+    std::remove(path); // Clean up the test file
+}
+
 #include "fakeheader.h"
\ No newline at end of file
@@ -58,4 +58,897 @@ std::mt19937 mt4{std::chrono::steady_clock::now().time_since_epoch().count()};
 // What happens if we want to use a random number generator in multiple functions or files?
 // The best way would be to have a single PRNG object that we can share and access anywhere.
 // This can be done by defining an INLINE random number object in a "Random.h" header file.
-// (Inline functions/variables are discussed in "Scope&Linkage")
\ No newline at end of file
+// (Inline functions/variables are discussed in "Scope&Linkage")
+
+/************************************
+    BETTER BOUNDED RANDOM NUMBERS
+************************************/
+
+// getRandNum() above has two problems.
+/* 1. It's BIASED. mt1() gives one of 2^32 values. If the range (y - x + 1) doesn't divide 2^32 evenly, some
+      results come up more often than others. For example, with a range of 3 * 2^30, the numbers 0 to 2^30
+      come up TWICE as often as the rest. For small ranges the bias is tiny, but it's never zero. */
+/* 2. It's SLOW(ish). % is a division, and division is one of the slowest things a CPU can do (often 20-40
+      times slower than a multiplication). */
+
+/* Daniel Lemire's method fixes both. Multiply the 32-bit random number by the range, giving a 64-bit
+   result. The top 32 bits are a number from 0 to range - 1. That alone would still be slightly biased, so
+   in the rare case where the bottom 32 bits land in a small "unfair" zone, we throw the number away and
+   draw another one ("rejection"). The division needed to find that zone only runs in that rare case. */
+
+#include <cstdint>
+
+// Returns a uniformly distributed number from 0 to range - 1. Works with any engine that produces
+// uniform 32-bit numbers, like std::mt19937. (range must not be 0.)
+template <typename Engine>
+std::uint32_t boundedRand(Engine& engine, std::uint32_t range) {
+    std::uint64_t product = std::uint64_t{static_cast<std::uint32_t>(engine())} * range;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+    if (low < range) { // Might be in the unfair zone. Only now do we pay for a division.
+        std::uint32_t threshold = (0u - range) % range; // 2^32 % range, without needing 64 bits
+        while (low < threshold) {
+            product = std::uint64_t{static_cast<std::uint32_t>(engine())} * range;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+// A drop-in replacement for getRandNum()
+int getRandNumFast(int x, int y) {
+    std::uint32_t range = static_cast<std::uint32_t>(y) - static_cast<std::uint32_t>(x) + 1;
+    if (range == 0) return static_cast<int>(mt1()); // x to y covers every possible int
+    return static_cast<int>(static_cast<std::uint32_t>(x) + boundedRand(mt1, range));
+}
+
+/* For random floating point numbers from 0 to 1, the usual trick is to divide by the largest possible
+   value, but that's also a division, and it doesn't give an even spread either. Instead, we take exactly as
+   many random bits as the type can hold (24 for float, 53 for double) and scale them with a multiply. */
+// These give a number in [0, 1), meaning 0 is possible but 1 isn't.
+
+template <typename Engine>
+float randFloat01(Engine& engine) {
+    return (static_cast<std::uint32_t>(engine()) >> 8) * 0x1.0p-24f; // 0x1.0p-24 is 2^-24, written in hex
+}
+
+// A 64-bit engine (like std::mt19937_64) has all 53 bits in one call. A 32-bit one needs two.
+template <typename Engine>
+double randDouble01(Engine& engine) {
+    if constexpr (Engine::min() == 0 && Engine::max() == UINT64_MAX) {
+        return (static_cast<std::uint64_t>(engine()) >> 11) * 0x1.0p-53;
+    } else {
+        std::uint64_t high = static_cast<std::uint32_t>(engine()), low = static_cast<std::uint32_t>(engine());
+        return (((high << 32) | low) >> 11) * 0x1.0p-53;
+    }
+}
+
+// And from a to b:
+template <typename Engine>
+double randDouble(Engine& engine, double a, double b) { return a + (b - a) * randDouble01(engine); }
+
+/* How do you know a random number generator is actually uniform? One standard check is the CHI-SQUARED
+   test: split the results into buckets, count how many land in each, and add up how far each count is from
+   what you'd expect. A uniform generator gives a total close to (buckets - 1). A much bigger total means
+   some buckets are getting too many results. */
+
+#include <vector>
+
+// Calls generate() "samples" times. generate() must return a bucket from 0 to buckets - 1.
+template <typename Generator>
+double chiSquared(Generator generate, std::uint32_t buckets, std::size_t samples) {
+    std::vector<std::size_t> counts(buckets);
+    for (std::size_t i = 0; i < samples; ++i) ++counts[generate()];
+    double expected = static_cast<double>(samples) / buckets, total = 0;
+    for (std::size_t count : counts) total += (count - expected) * (count - expected) / expected;
+    return total;
+}
+
+#include <iostream>
+
+void testUniformity() {
+    std::mt19937 mt{42};
+    constexpr std::size_t samples = 3'000'000;
+    auto report = [](const char* name, double total, double limit) {
+        std::cout << name << total << (total < limit ? " (pass)\n" : " (FAIL: not uniform)\n");
+    };
+
+    // With 10 buckets, a total above about 27.9 has less than a 0.1% chance of happening by luck.
+    report("boundedRand, range 10:       ", chiSquared([&] { return boundedRand(mt, 10); }, 10, samples), 27.9);
+    report("randDouble01, 10 buckets:    ",
+           chiSquared([&] { return static_cast<std::uint32_t>(randDouble01(mt) * 10); }, 10, samples), 27.9);
+
+    // The range 3 * 2^30 makes modulo's bias obvious. Split the range into 3 equal buckets.
+    // With 3 buckets, a total above about 13.8 has less than a 0.1% chance of happening by luck.
+    constexpr std::uint32_t bigRange = 3u << 30;
+    report("modulo, range 3 * 2^30:      ",
+           chiSquared([&] { return (mt() % bigRange) >> 30; }, 3, samples), 13.8);
+    report("boundedRand, range 3 * 2^30: ",
+           chiSquared([&] { return boundedRand(mt, bigRange) >> 30; }, 3, samples), 13.8);
+}
+
+// And a throughput benchmark:
+
+#include <chrono>
+
+// Every benchmark in this file uses this. It runs func() "repeats" times and returns how many milliseconds
+// that took in total.
+template <typename Func>
+double timeIt(Func func, std::size_t repeats = 1) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < repeats; ++i) func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void benchmarkBoundedRand() {
+    std::mt19937 mt{42};
+    constexpr int count = 50'000'000;
+    std::uint32_t range = 1000;
+    std::uint64_t sum = 0; // Printed too, so the compiler can't skip making the numbers
+
+    // The range is read from a volatile so the compiler can't cheat by turning % into a multiply
+    volatile std::uint32_t rangeSource = range;
+    range = rangeSource;
+    std::cout << "mt() % range:                  " << timeIt([&] { sum += mt() % range; }, count) << "ms\n";
+    std::uniform_int_distribution<std::uint32_t> distribution(0, range - 1);
+    std::cout << "std::uniform_int_distribution: " << timeIt([&] { sum += distribution(mt); }, count) << "ms\n";
+    std::cout << "boundedRand:                   " << timeIt([&] { sum += boundedRand(mt, range); }, count)
+              << "ms (sum " << sum << ")\n";
+}
+
+/**************************
+    SMALL, FAST ENGINES
+**************************/
+
+// std::mt19937 is a good default, but it has some real costs:
+// - Its state is 624 numbers, so 2.5KB to 5KB depending on the library. One per object adds up fast.
+// - Seeding it properly (filling all 624 numbers and warming up) takes time.
+/* If every task or particle in your program needs its own generator, you want one that's tiny and quick to
+   seed. Here are three popular ones. They are all "UniformRandomBitGenerators", which just means they have
+   result_type, min(), max(), and operator(). That's all that <random>'s distributions need, so they work
+   anywhere std::mt19937 does. */
+
+#include <cstdint>
+#include <limits>
+
+// SplitMix64: 8 bytes of state. Very fast and decent quality. Its main job is turning one seed number into
+// good seeds for other generators, since even similar seeds (like 1, 2, 3) give completely different output.
+class SplitMix64 {
+    std::uint64_t state;
+public:
+    using result_type = std::uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit SplitMix64(std::uint64_t seed = 0) : state(seed) {}
+    void seed(std::uint64_t seed) { state = seed; }
+
+    result_type operator()() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+};
+
+// Rotates the bits left, so bits shifted off the top come back in at the bottom
+constexpr std::uint64_t rotateLeft(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// xoshiro256**: 32 bytes of state, excellent quality, and one of the fastest generators around.
+// All it does is a few shifts, XORs, and rotations. Made by David Blackman and Sebastiano Vigna.
+class Xoshiro256StarStar {
+    std::uint64_t s[4];
+public:
+    using result_type = std::uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit Xoshiro256StarStar(std::uint64_t seed = 0) { this->seed(seed); }
+    // The state must not be all zeros, and SplitMix64 guarantees a good spread of bits
+    void seed(std::uint64_t seed) {
+        SplitMix64 seeder(seed);
+        for (std::uint64_t& word : s) word = seeder();
+    }
+
+    // The raw state, for code that runs the same algorithm itself (like BulkRandom below)
+    std::uint64_t state(int i) const { return s[i]; }
+
+    result_type operator()() {
+        std::uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+        std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotateLeft(s[3], 45);
+        return result;
+    }
+
+    // Skips ahead 2^128 numbers, as if we'd called operator() that many times.
+    /* This works because each step is a linear function of the state bits, so 2^128 steps can be boiled
+       down to a fixed "jump polynomial" (the constants below). Applying it takes 256 steps, not 2^128. */
+    void jump() {
+        static constexpr std::uint64_t jumpPolynomial[] = {0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C,
+                                                           0xA9582618E03FC9AA, 0x39ABDC4529B1661C};
+        std::uint64_t jumped[4] = {};
+        for (std::uint64_t word : jumpPolynomial) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (std::uint64_t{1} << bit)) {
+                    for (int i = 0; i < 4; ++i) jumped[i] ^= s[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i) s[i] = jumped[i];
+    }
+};
+
+// PCG64: 32 bytes of state, excellent quality. Made by Melissa O'Neill.
+/* It's a simple "multiply and add" generator with a 128-bit state, plus a clever scrambling step on the
+   output. It needs 128-bit integers, which GCC and Clang have as "unsigned __int128" (MSVC doesn't). */
+#ifdef __SIZEOF_INT128__
+class Pcg64 {
+    using uint128 = unsigned __int128;
+    uint128 state = 0;
+    uint128 increment; // Must be odd. Different increments give completely separate sequences ("streams").
+
+    static constexpr uint128 multiplier =
+        (uint128{0x2360ED051FC65DA4} << 64) | 0x4385DF649FCCF645;
+
+    void step() { state = state * multiplier + increment; }
+public:
+    using result_type = std::uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit Pcg64(std::uint64_t seed = 0, std::uint64_t stream = 0) { this->seed(seed, stream); }
+    void seed(std::uint64_t seed, std::uint64_t stream = 0) {
+        increment = (uint128{stream} << 1) | 1;
+        state = 0;
+        step();
+        state += seed;
+        step();
+    }
+
+    result_type operator()() {
+        step();
+        // "XSL RR": fold the 128 bits down to 64 with an XOR, then rotate by an amount taken from the top bits
+        std::uint64_t folded = static_cast<std::uint64_t>(state >> 64) ^ static_cast<std::uint64_t>(state);
+        int rotation = static_cast<int>(state >> 122);
+        return (folded >> rotation) | (folded << ((64 - rotation) & 63));
+    }
+};
+#endif
+
+// All of these work with <random>'s distributions, just like std::mt19937:
+
+void smallEngineExamples() {
+    Xoshiro256StarStar xoshiro{12345};
+    std::uniform_int_distribution<int> die(1, 6);
+    int roll = die(xoshiro);
+
+    std::normal_distribution<double> normal(0.0, 1.0);
+    double noise = normal(xoshiro);
+}
+
+// And here's a benchmark comparing them to std::mt19937 and std::mt19937_64:
+
+#include <chrono>
+#include <iostream>
+
+template <typename Engine>
+void benchmarkEngine(const char* name) {
+    // Seeding: create 1 million generators, each with its own seed (like one per particle)
+    std::uint64_t sum = 0;
+    std::uint64_t seed = 0;
+    double seedTime = timeIt([&] {
+        Engine engine(seed++);
+        sum += engine();
+    }, 1'000'000);
+
+    // Speed: generate 800MB worth of random bits (so the 32-bit mt19937 needs twice as many calls)
+    Engine engine(42);
+    // Not result_type's size: std::mt19937 hands out 32 random bits in a uint_fast32_t, which is 64 bits wide
+    constexpr int bitsPerCall = Engine::max() <= UINT32_MAX ? 32 : 64;
+    constexpr std::uint64_t calls = 200'000'000ull * 32 / bitsPerCall;
+    double generateTime = timeIt([&] { sum += engine(); }, calls);
+
+    std::cout << name << sizeof(Engine) << " bytes, 1M seedings: " << seedTime << "ms, "
+              << (200.0 * 32 / 8) / (generateTime / 1000) << " MB/s of random bits (" << (sum & 1) << ")\n";
+}
+
+void benchmarkEngines() {
+    benchmarkEngine<std::mt19937>("std::mt19937:        ");
+    benchmarkEngine<std::mt19937_64>("std::mt19937_64:     ");
+    benchmarkEngine<SplitMix64>("SplitMix64:          ");
+    benchmarkEngine<Xoshiro256StarStar>("Xoshiro256StarStar:  ");
+#ifdef __SIZEOF_INT128__
+    benchmarkEngine<Pcg64>("Pcg64:               ");
+#endif
+}
+
+/*****************************************
+    SHARING RANDOMNESS BETWEEN THREADS
+*****************************************/
+
+// Earlier we said the best way to share a PRNG is one inline object in "Random.h". That breaks with threads.
+/* If two threads call the same engine at once, that's a data race (undefined behavior). Putting a mutex
+   around it makes every thread wait in line for each number. And even if it worked, the results would depend
+   on which thread happened to get there first, so the same seed wouldn't give the same results anymore. */
+/* The fix: give every thread its OWN engine, all built from one "master seed". Just seeding each one with
+   masterSeed + 1, + 2... is risky, since nothing guarantees those sequences don't overlap. Instead we use
+   Xoshiro256StarStar's jump(): stream 1 starts 2^128 numbers into the master sequence, stream 2 starts 2^128
+   after that, and so on. No thread could ever use up 2^128 numbers, so the streams can never overlap. */
+
+// So "Random.h" would look like this:
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+namespace Random {
+    // Set this once, before starting any threads. Same master seed = same results, every run.
+    inline std::uint64_t masterSeed = 5489;
+
+    // Returns the engine for stream "index". Same master seed and index always give the same engine.
+    // This costs one jump per index, so if you need lots of streams, make them in a loop with one jump each.
+    inline Xoshiro256StarStar stream(std::uint64_t index) {
+        Xoshiro256StarStar engine(masterSeed);
+        for (std::uint64_t i = 0; i < index; ++i) engine.jump();
+        return engine;
+    }
+
+    // "thread_local" gives every thread its own copy of this variable, so no locks are needed.
+    /* It starts out EMPTY on purpose. If every thread quietly started on stream 0, then forgetting to call
+       useStream() would give every thread the exact same numbers, and nothing would tell you. */
+    inline thread_local std::optional<Xoshiro256StarStar> engine;
+
+    inline void useStream(std::uint64_t index) { engine = stream(index); }
+
+    // This thread's engine. Throws if this thread never called useStream().
+    inline Xoshiro256StarStar& threadEngine() {
+        if (!engine) throw std::logic_error("Random: call useStream() on this thread before using it");
+        return *engine;
+    }
+
+    // A random int from x to y (inclusive), from this thread's engine
+    inline int get(int x, int y) {
+        Xoshiro256StarStar& threadRng = threadEngine();
+        std::uint32_t range = static_cast<std::uint32_t>(y) - static_cast<std::uint32_t>(x) + 1;
+        if (range == 0) return static_cast<int>(threadRng());
+        return static_cast<int>(static_cast<std::uint32_t>(x) + boundedRand(threadRng, range));
+    }
+}
+
+/* IMPORTANT: the stream index should come from the WORK, not the thread. If threads grab jobs from a shared
+   queue, which thread gets which job changes every run. So give each JOB (or chunk of work) its own stream.
+   Then the results are the same no matter how many threads there are or how they get scheduled. */
+
+// Here's an example that estimates pi. It splits the work into 64 chunks, and threads take whichever chunk
+// is next. The answer is exactly the same with 1 thread or 8, every time:
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+double estimatePi(unsigned threadCount) {
+    constexpr std::size_t chunkCount = 64, pointsPerChunk = 1'000'000;
+
+    // Make every chunk's engine up front, with one jump each (chunk 0 gets stream 1, and so on)
+    std::vector<Xoshiro256StarStar> chunkEngines;
+    Xoshiro256StarStar engine = Random::stream(0);
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        engine.jump();
+        chunkEngines.push_back(engine);
+    }
+
+    std::atomic<std::size_t> nextChunk{0};
+    std::vector<std::size_t> hits(chunkCount);
+    auto worker = [&] {
+        for (std::size_t chunk; (chunk = nextChunk++) < chunkCount;) {
+            Xoshiro256StarStar& chunkEngine = chunkEngines[chunk];
+            std::size_t inside = 0;
+            for (std::size_t i = 0; i < pointsPerChunk; ++i) {
+                double x = randDouble01(chunkEngine), y = randDouble01(chunkEngine);
+                inside += (x * x + y * y < 1.0);
+            }
+            hits[chunk] = inside; // Each chunk has its own slot, so the threads never write to the same place
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadCount; ++i) threads.emplace_back(worker);
+    for (std::thread& thread : threads) thread.join();
+
+    std::size_t totalHits = 0;
+    for (std::size_t inside : hits) totalHits += inside;
+    return 4.0 * totalHits / (chunkCount * pointsPerChunk);
+}
+
+void parallelRandomExample() {
+    Random::masterSeed = 2024;
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads : {1u, 2u, maxThreads})
+        std::cout << threads << " thread(s): pi is about " << estimatePi(threads) << '\n'; // Always the same
+}
+
+/*****************************
+    FILLING ARRAYS IN BULK
+*****************************/
+
+// Calling an engine once per number is fine for a few numbers, but it's slow for filling big arrays.
+/* Each xoshiro step depends on the one before it, so the CPU can't start the next number until the last
+   one is done. On top of that, std::uniform_real_distribution and std::normal_distribution add their own
+   overhead to every call, and the math inside them (log, sqrt, sin, cos) is done one number at a time. */
+/* The fix is to run several independent engines side by side ("lanes"). We keep the states as 4 arrays
+   (all the s[0]s together, all the s[1]s together...) instead of an array of engines. The lanes don't depend
+   on each other, so one SIMD instruction can update 4 of them (AVX2) or 8 of them (AVX-512) at once. */
+// Each lane is one jump() further along than the last, so the lanes never overlap, and the same seed always
+// fills arrays with the same numbers.
+/* The compiler can vectorize a simple loop over the lanes by itself, but only with the instructions the
+   whole program is compiled for. Without -mavx2 or -march=native, that's SSE2, which fits just 2 lanes and
+   doesn't have a 64-bit rotate. It also reloads every lane's state from memory for every single step. So the
+   step is written by hand with intrinsics below: AVX2 or AVX-512 is picked when the program runs, and the
+   state stays in registers for as many steps as we need. The conversions to double and float afterwards are
+   simple loops, and those the compiler does vectorize on its own (at -O3, or at -O2 from GCC 12 on). */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+// Like fastFind() in "Strings", the SIMD versions are only built with GCC or Clang on x86-64, and
+// __builtin_cpu_supports() picks one when the program runs.
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAS_SIMD_XOSHIRO 1
+
+// Each struct does one xoshiro256** step on a whole vector of lanes, and returns the output of every lane.
+// x * 5 is (x << 2) + x and x * 9 is (x << 3) + x, since AVX2 can't multiply 64-bit numbers.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi" // Same as in "Strings": these all get inlined
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized" // A false alarm from inside GCC 12's AVX-512 header
+struct XoshiroAvx2 {
+    using Vec = __m256i;
+    static constexpr std::size_t width = 4; // 4 lanes of 64 bits
+    __attribute__((target("avx2"))) static Vec load(const std::uint64_t* p) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static void store(std::uint64_t* p, Vec v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    __attribute__((target("avx2"))) static Vec step(Vec& s0, Vec& s1, Vec& s2, Vec& s3) {
+        Vec times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+        Vec rotated = _mm256_or_si256(_mm256_slli_epi64(times5, 7), _mm256_srli_epi64(times5, 57));
+        Vec result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+        Vec t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+        return result;
+    }
+};
+
+// AVX-512 has twice the lanes, and a real 64-bit rotate instruction
+struct XoshiroAvx512 {
+    using Vec = __m512i;
+    static constexpr std::size_t width = 8;
+    __attribute__((target("avx512f"))) static Vec load(const std::uint64_t* p) { return _mm512_load_si512(p); }
+    __attribute__((target("avx512f"))) static void store(std::uint64_t* p, Vec v) { _mm512_storeu_si512(p, v); }
+    __attribute__((target("avx512f"))) static Vec step(Vec& s0, Vec& s1, Vec& s2, Vec& s3) {
+        Vec rotated = _mm512_rol_epi64(_mm512_add_epi64(_mm512_slli_epi64(s1, 2), s1), 7);
+        Vec result = _mm512_add_epi64(_mm512_slli_epi64(rotated, 3), rotated);
+        Vec t = _mm512_slli_epi64(s1, 17);
+        s2 = _mm512_xor_si512(s2, s0);
+        s3 = _mm512_xor_si512(s3, s1);
+        s1 = _mm512_xor_si512(s1, s2);
+        s0 = _mm512_xor_si512(s0, s3);
+        s2 = _mm512_xor_si512(s2, t);
+        s3 = _mm512_rol_epi64(s3, 45);
+        return result;
+    }
+};
+
+// Runs "blocks" steps of all 8 lanes, writing 8 numbers per step. The state stays in registers the whole
+// time, and only goes back to memory at the end.
+template <typename Simd>
+__attribute__((always_inline)) inline void simdXoshiroBlocks(std::uint64_t* state, std::uint64_t* out,
+                                                             std::size_t blocks) {
+    constexpr std::size_t n = 8 / Simd::width; // Vectors per state word (2 for AVX2, 1 for AVX-512)
+    typename Simd::Vec s0[n], s1[n], s2[n], s3[n];
+    for (std::size_t j = 0; j < n; ++j) {
+        s0[j] = Simd::load(state + j * Simd::width);
+        s1[j] = Simd::load(state + 8 + j * Simd::width);
+        s2[j] = Simd::load(state + 16 + j * Simd::width);
+        s3[j] = Simd::load(state + 24 + j * Simd::width);
+    }
+    for (std::size_t block = 0; block < blocks; ++block, out += 8) {
+        for (std::size_t j = 0; j < n; ++j) {
+            Simd::store(out + j * Simd::width, Simd::step(s0[j], s1[j], s2[j], s3[j]));
+        }
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+        Simd::store(state + j * Simd::width, s0[j]);
+        Simd::store(state + 8 + j * Simd::width, s1[j]);
+        Simd::store(state + 16 + j * Simd::width, s2[j]);
+        Simd::store(state + 24 + j * Simd::width, s3[j]);
+    }
+}
+
+// The entry points. (The target attribute has to be on these too, so the helpers can be inlined.)
+__attribute__((target("avx2"))) inline void xoshiroBlocksAvx2(std::uint64_t* state, std::uint64_t* out,
+                                                              std::size_t blocks) {
+    simdXoshiroBlocks<XoshiroAvx2>(state, out, blocks);
+}
+__attribute__((target("avx512f"))) inline void xoshiroBlocksAvx512(std::uint64_t* state, std::uint64_t* out,
+                                                                   std::size_t blocks) {
+    simdXoshiroBlocks<XoshiroAvx512>(state, out, blocks);
+}
+#pragma GCC diagnostic pop
+#endif
+
+class BulkRandom {
+    static constexpr std::size_t lanes = 8;
+    // Numbers are made in chunks of this many blocks, small enough to stay in the L1 cache until they're used
+    static constexpr std::size_t chunkBlocks = 64;
+    // state[0..7] is every lane's s[0], state[8..15] is every lane's s[1], and so on.
+    // alignas(64) lines them up for SIMD loads.
+    alignas(64) std::uint64_t state[4 * lanes];
+
+    // "blocks" xoshiro256** steps in every lane, writing one number per lane per step to "out"
+    void nextBlocks(std::uint64_t* out, std::size_t blocks) {
+#ifdef HAS_SIMD_XOSHIRO
+        static const auto impl = __builtin_cpu_supports("avx512f") ? xoshiroBlocksAvx512
+                               : __builtin_cpu_supports("avx2") ? xoshiroBlocksAvx2 : nullptr;
+        if (impl) return impl(state, out, blocks);
+#endif
+        // Without SIMD, one lane at a time is quickest, since then its whole state fits in registers
+        for (std::size_t i = 0; i < lanes; ++i) {
+            std::uint64_t s0 = state[i], s1 = state[lanes + i];
+            std::uint64_t s2 = state[2 * lanes + i], s3 = state[3 * lanes + i];
+            for (std::size_t block = 0; block < blocks; ++block) {
+                out[block * lanes + i] = rotateLeft(s1 * 5, 7) * 9;
+                std::uint64_t t = s1 << 17;
+                s2 ^= s0;
+                s3 ^= s1;
+                s1 ^= s2;
+                s0 ^= s3;
+                s2 ^= t;
+                s3 = rotateLeft(s3, 45);
+            }
+            state[i] = s0, state[lanes + i] = s1, state[2 * lanes + i] = s2, state[3 * lanes + i] = s3;
+        }
+    }
+
+    /* fillNormal() needs a log, a square root, a sine and a cosine for every pair of numbers. But std::log()
+       and friends are function calls that the compiler can't vectorize. (std::sqrt() is usually a single
+       instruction, but it also has to set errno for negative numbers, and that extra check blocks
+       vectorization too.) So here are simple versions made only of arithmetic, accurate to about 1e-6. */
+
+    // ln(m / 2^24), for m from 1 to 2^24
+    static float logFraction(std::uint32_t m) {
+        // Split the float into 2^exponent * f by pulling its bits apart (see "Bit_Manipulation").
+        // The offsets make f land between about 0.71 and 1.41 instead of 1 and 2, where the series below is
+        // quickest, without needing an if statement.
+        float x = static_cast<float>(static_cast<std::int32_t>(m)); // (int to float is quicker in SIMD)
+        std::uint32_t bits;
+        std::memcpy(&bits, &x, sizeof bits);
+        bits += 0x3F800000 - 0x3F3504F3; // 0x3F3504F3 is the bits of 1 / sqrt(2)
+        int exponent = static_cast<int>(bits >> 23) - 127 - 24;
+        bits = (bits & 0x7FFFFF) + 0x3F3504F3;
+        float f;
+        std::memcpy(&f, &bits, sizeof f);
+        // ln(f) = 2 * (s + s^3/3 + s^5/5 + ...), where s = (f - 1) / (f + 1)
+        float s = (f - 1) / (f + 1), s2 = s * s;
+        float lnF = s * (2 + s2 * (2.0f / 3 + s2 * (2.0f / 5 + s2 * (2.0f / 7 + s2 * (2.0f / 9)))));
+        return lnF + exponent * 0.693147180559945f; // ln(2^exponent * f) = exponent * ln(2) + ln(f)
+    }
+
+    // The square root, using the famous "fast inverse square root" from Quake III plus 3 Newton's method
+    // steps. (Each step roughly doubles the number of correct digits.) x must be 0 or more.
+    static float squareRoot(float x) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &x, sizeof bits);
+        bits = 0x5F3759DF - (bits >> 1);
+        float y; // About 1 / sqrt(x), to within 4%
+        std::memcpy(&y, &bits, sizeof y);
+        y = y * (1.5f - 0.5f * x * y * y);
+        y = y * (1.5f - 0.5f * x * y * y);
+        y = y * (1.5f - 0.5f * x * y * y);
+        return x * y; // x / sqrt(x) = sqrt(x)
+    }
+
+    // The cosine and sine of a whole turn * (m / 2^24), for m from 0 to 2^24 - 1
+    static void cosSinTurn(std::uint32_t m, float& cosine, float& sine) {
+        // The top 2 bits say which quarter of the circle we're in. The rest is an angle from 0 to pi/2, which
+        // we shift to -pi/4 to pi/4, where the Taylor series below are accurate.
+        std::uint32_t quarter = m >> 22;
+        float t = static_cast<std::int32_t>(m & 0x3FFFFF) * (6.28318530717958648f * 0x1.0p-24f) - 0.78539816f;
+        float t2 = t * t;
+        float sinT = t * (1 + t2 * (-1.0f / 6 + t2 * (1.0f / 120 + t2 * (-1.0f / 5040 + t2 / 362880))));
+        float cosT = 1 + t2 * (-0.5f + t2 * (1.0f / 24 + t2 * (-1.0f / 720 + t2 * (1.0f / 40320))));
+        // Add the pi/4 back:
+        // cos(t + pi/4) = (cos t - sin t) / sqrt(2) and sin(t + pi/4) = (sin t + cos t) / sqrt(2)
+        float c = (cosT - sinT) * 0.707106781f, s = (sinT + cosT) * 0.707106781f;
+        // And rotate by the quarter turns
+        cosine = quarter == 0 ? c : quarter == 1 ? -s : quarter == 2 ? -c : s;
+        sine = quarter == 0 ? s : quarter == 1 ? c : quarter == 2 ? -s : -c;
+    }
+    /* The top 53 bits of x, as a double. That's just static_cast<double>(x >> 11), but SIMD instruction sets
+       before AVX-512 can't convert 64-bit integers to doubles, so the compiler would do that one at a time.
+       Instead, we put each half of the number straight into the bits of a double, since a double whose
+       exponent is 2^52 holds a 52-bit whole number as-is. Then we subtract the exponents back out. */
+    static double top53Bits(std::uint64_t x) {
+        std::uint64_t highBits = (x >> 43) | 0x4530000000000000; // 2^84 + (top 21 bits) * 2^32
+        std::uint64_t lowBits = ((x >> 11) & 0xFFFFFFFF) | 0x4330000000000000; // 2^52 + (next 32 bits)
+        double high, low;
+        std::memcpy(&high, &highBits, sizeof high);
+        std::memcpy(&low, &lowBits, sizeof low);
+        return (high - 0x1.00000001p84) + low; // 0x1.00000001p84 is 2^84 + 2^52. Every step here is exact.
+    }
+public:
+    explicit BulkRandom(std::uint64_t seed = 0) {
+        Xoshiro256StarStar engine(seed);
+        for (std::size_t i = 0; i < lanes; ++i) {
+            for (int word = 0; word < 4; ++word) state[word * lanes + i] = engine.state(word);
+            engine.jump();
+        }
+    }
+
+    // Fills out[0] to out[count - 1] with random 32-bit numbers (two from each 64-bit number)
+    void fill(std::uint32_t* out, std::size_t count) {
+        constexpr std::size_t perChunk = 2 * lanes * chunkBlocks;
+        alignas(64) std::uint64_t chunk[lanes * chunkBlocks];
+        for (std::size_t i = 0; i < count; i += perChunk) {
+            std::size_t n = count - i < perChunk ? count - i : perChunk;
+            nextBlocks(chunk, (n + 2 * lanes - 1) / (2 * lanes));
+            std::memcpy(out + i, chunk, n * sizeof(std::uint32_t)); // Copying the bytes is the fastest split
+        }
+    }
+
+    // Fills with doubles from a to b (well, [a, b)), using 53 random bits each like randDouble01()
+    void fillUniform(double* out, std::size_t count, double a, double b) {
+        constexpr std::size_t perChunk = lanes * chunkBlocks;
+        alignas(64) std::uint64_t chunk[perChunk];
+        double scale = (b - a) * 0x1.0p-53;
+        for (std::size_t i = 0; i < count; i += perChunk) {
+            std::size_t n = count - i < perChunk ? count - i : perChunk;
+            nextBlocks(chunk, (n + lanes - 1) / lanes);
+            for (std::size_t k = 0; k < n; ++k) out[i + k] = a + top53Bits(chunk[k]) * scale;
+        }
+    }
+
+    // Fills with normally distributed floats (mean 0, standard deviation 1).
+    /* This uses the Box-Muller transform: two uniform numbers u1 and u2 become the point
+       (sqrt(-2 ln u1) * cos(2 pi u2), sqrt(-2 ln u1) * sin(2 pi u2)), and both coordinates are normal.
+       std::normal_distribution usually uses a version that throws some numbers away and tries again. That's
+       fine one number at a time, but lanes can't retry separately. Box-Muller never retries.
+       One 64-bit number is enough for both u1 and u2 (24 bits each, like randFloat01()). */
+    void fillNormal(float* out, std::size_t count) {
+        constexpr std::size_t perChunk = 2 * lanes * chunkBlocks;
+        alignas(64) std::uint64_t chunk[lanes * chunkBlocks];
+        alignas(64) float pairs[perChunk];
+        for (std::size_t i = 0; i < count; i += perChunk) {
+            std::size_t n = count - i < perChunk ? count - i : perChunk;
+            std::size_t blocks = (n + 2 * lanes - 1) / (2 * lanes);
+            nextBlocks(chunk, blocks);
+            for (std::size_t k = 0; k < blocks * lanes; ++k) {
+                // u1 is in (0, 1] instead of [0, 1), so we never take the log of 0
+                float radius = squareRoot(-2 * logFraction(static_cast<std::uint32_t>(chunk[k] >> 40) + 1));
+                float cosine, sine;
+                cosSinTurn(static_cast<std::uint32_t>(chunk[k] >> 8) & 0xFFFFFF, cosine, sine);
+                pairs[2 * k] = radius * cosine;
+                pairs[2 * k + 1] = radius * sine;
+            }
+            std::memcpy(out + i, pairs, n * sizeof(float));
+        }
+    }
+
+#if __cplusplus >= 202002L // The same thing with std::span, in C++20
+    void fill(std::span<std::uint32_t> out) { fill(out.data(), out.size()); }
+    void fillUniform(std::span<double> out, double a, double b) { fillUniform(out.data(), out.size(), a, b); }
+    void fillNormal(std::span<float> out) { fillNormal(out.data(), out.size()); }
+#endif
+};
+
+// A benchmark against calling an engine once per number. The fair comparison is Xoshiro256StarStar, since
+// every lane is one. (Beating std::mt19937 is easy, it's just slow.)
+/* The arrays are kept small enough to stay in the cache, and refilled many times. With one huge array, every
+   version would spend most of its time waiting for the writes to reach memory, which hides the difference. */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+void benchmarkBulkRandom() {
+    constexpr std::size_t count = 1 << 16, rounds = 160; // About 10 million numbers each
+    std::vector<std::uint32_t> ints(count);
+    std::vector<double> doubles(count);
+    std::vector<float> floats(count);
+    std::mt19937 mt{42};
+    Xoshiro256StarStar xoshiro{42};
+    BulkRandom bulk{42};
+
+    auto timeRounds = [](const char* name, auto fillOnce) { // Prints the time, and returns it for speedup()
+        double ms = timeIt(fillOnce, rounds);
+        std::cout << name << ms << "ms\n";
+        return ms;
+    };
+    auto speedup = [](double perCall, double bulk) {
+        std::cout << "    (" << perCall / bulk << "x as fast as calling Xoshiro256StarStar)\n";
+    };
+
+    timeRounds("32-bit ints, std::mt19937:            ", [&] { for (auto& x : ints) x = mt(); });
+    double perCall = timeRounds("32-bit ints, Xoshiro256StarStar:      ", [&] {
+        for (std::size_t i = 0; i < count; i += 2) { // Two from each call, just like fill()
+            std::uint64_t both = xoshiro();
+            ints[i] = static_cast<std::uint32_t>(both);
+            ints[i + 1] = static_cast<std::uint32_t>(both >> 32);
+        }
+    });
+    speedup(perCall, timeRounds("32-bit ints, BulkRandom::fill:        ",
+                                [&] { bulk.fill(ints.data(), count); }));
+
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    timeRounds("doubles, uniform_real_distribution:   ", [&] { for (auto& x : doubles) x = uniform(mt); });
+    perCall = timeRounds("doubles, randDouble(xoshiro):         ",
+                         [&] { for (auto& x : doubles) x = randDouble(xoshiro, -1, 1); });
+    speedup(perCall, timeRounds("doubles, BulkRandom::fillUniform:     ",
+                                [&] { bulk.fillUniform(doubles.data(), count, -1, 1); }));
+
+    std::normal_distribution<float> normal;
+    timeRounds("floats, normal_distribution(mt):      ", [&] { for (auto& x : floats) x = normal(mt); });
+    perCall = timeRounds("floats, normal_distribution(xoshiro): ",
+                         [&] { for (auto& x : floats) x = normal(xoshiro); });
+    speedup(perCall, timeRounds("floats, BulkRandom::fillNormal:       ",
+                                [&] { bulk.fillNormal(floats.data(), count); }));
+}
+
+/***********************************
+    COUNTER-BASED RANDOM NUMBERS
+***********************************/
+
+// Every engine so far updates a state, so getting the Nth number means computing every number before it.
+// (Xoshiro's jump() helps, but only in huge fixed steps of 2^128.)
+/* A COUNTER-BASED engine works differently: the Nth number is just a scrambled version of N itself.
+   random(N) = scramble(N, key). There's no state to update and nothing to warm up. Any thread can compute
+   any part of the sequence directly, so a chunk of work can always be redone on any core and get exactly the
+   same numbers. It also avoids reseeding: a new stream is just a different key or a different counter range. */
+/* Philox4x32-10 (from the "Random123" library by Salmon, Moraes, Dror and Shaw) is the most popular one.
+   It scrambles a 128-bit counter (4 x 32 bits) with a 64-bit key, in 10 rounds of multiplying and XORing.
+   Each counter gives 4 random 32-bit numbers. GPU libraries like cuRAND offer it, and PyTorch uses it on
+   GPUs. */
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+class Philox4x32 {
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    // The scramble itself. It's constexpr, so it can even be checked at compile time (see below).
+    static constexpr Counter scramble(Counter counter, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) { // Change the key a little before every round but the first
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            // Multiply 2 of the numbers by big constants, keeping both halves of the 64-bit results
+            std::uint64_t product0 = std::uint64_t{0xD2511F53} * counter[0];
+            std::uint64_t product1 = std::uint64_t{0xCD9E8D57} * counter[2];
+            auto high = [](std::uint64_t x) { return static_cast<std::uint32_t>(x >> 32); };
+            auto low = [](std::uint64_t x) { return static_cast<std::uint32_t>(x); };
+            counter = {high(product1) ^ counter[1] ^ key[0], low(product1),
+                       high(product0) ^ counter[3] ^ key[1], low(product0)};
+        }
+        return counter;
+    }
+
+private:
+    Key key;
+    std::uint64_t stream;   // Goes in the top half of the counter, so every stream gets its own 2^64 blocks
+    std::uint64_t block = 0; // Which group of 4 numbers we're on (the bottom half of the counter)
+    Counter output{};
+    int used = 4; // How many numbers of "output" we've handed out already. 4 means we need a new block.
+
+    void refill() {
+        Counter counter = {static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32),
+                           static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)};
+        output = scramble(counter, key);
+        ++block;
+        used = 0;
+    }
+
+public:
+    using result_type = std::uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+        this->key = {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+        this->stream = stream;
+    }
+
+    result_type operator()() {
+        if (used == 4) refill();
+        return output[used++];
+    }
+
+    // Jumps straight to the index-th number of this stream (counting from 0). This is O(1), so it doesn't
+    // matter how far away it is.
+    void seek(std::uint64_t index) {
+        block = index / 4;
+        refill();
+        used = static_cast<int>(index % 4);
+    }
+
+    // Which number operator() will return next
+    std::uint64_t position() const {
+        if (used == 4) return block * 4;
+        return (block - 1) * 4 + used; // "block" has already moved past the block we're handing out
+    }
+
+    // Skips n numbers, like the standard engines' discard(). Also O(1).
+    void discard(std::uint64_t n) { seek(position() + n); }
+};
+
+// So a big simulation can give every chunk of work its own starting point, and recompute it anywhere:
+/*
+    Philox4x32 engine(masterSeed);
+    engine.seek(chunk * numbersPerChunk);
+    ... use engine like any other engine ...
+*/
+
+// KNOWN-ANSWER TESTS. When you write a well-known algorithm yourself, always check it against the official
+// test vectors. Random123 publishes these for Philox4x32-10 (counter, key -> result):
+constexpr bool scramblesTo(Philox4x32::Counter counter, Philox4x32::Key key, Philox4x32::Counter expected) {
+    Philox4x32::Counter result = Philox4x32::scramble(counter, key);
+    for (int i = 0; i < 4; ++i) {
+        if (result[i] != expected[i]) return false;
+    }
+    return true;
+}
+
+// static_assert stops the program from compiling if the condition is false, so these cost nothing at run time
+static_assert(scramblesTo({0, 0, 0, 0}, {0, 0}, {0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8}));
+static_assert(scramblesTo({0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}, {0xFFFFFFFF, 0xFFFFFFFF},
+                          {0x408F276D, 0x41C83B0E, 0xA20BC7C6, 0x6D5451FD}));
+static_assert(scramblesTo({0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344}, {0xA4093822, 0x299F31D0},
+                          {0xD16CFE09, 0x94FDCCEB, 0x5001E420, 0x24126EA1}));
+
+// And a run-time test that jumping around gives exactly the same numbers as going in order:
+
+#include <cassert>
+#include <vector>
+
+void testPhilox() {
+    Philox4x32 inOrder(2024, 7);
+    std::vector<std::uint32_t> expected(1000);
+    for (std::uint32_t& number : expected) number = inOrder();
+
+    Philox4x32 jumping(2024, 7);
+    for (std::uint64_t index : {999u, 0u, 500u, 3u, 4u, 998u, 1u}) {
+        jumping.seek(index);
+        assert(jumping.position() == index);
+        assert(jumping() == expected[index]);
+        assert(jumping.position() == index + 1);
+    }
+    jumping.seek(10);
+    jumping.discard(90);
+    assert(jumping() == expected[100]);
+
+    // Different streams (or seeds) give unrelated numbers
+    Philox4x32 otherStream(2024, 8);
+    assert(otherStream() != expected[0]);
+}
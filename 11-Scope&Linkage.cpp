@@ -92,7 +92,7 @@ cout << "Hello";
 using namespace std; // Considered a using-directive
 
 int userInput;
-cin >> userInput;
+cin >> userInput; // (For reading lots of input quickly, see "FAST CONSOLE INPUT" in "Console")
 
 // The using declaration/directive is active from the point of it's declaration to the end of it's scope.
 // Never put the "using" keyword in header files.
@@ -451,4 +451,111 @@ class Class2 {
    mean A is a friend of C. */
 // Nor is friendship inherited. If class A makes B a friend, classes derived from B are not friends of A.
 // A friend class declaration acts as a forward declaration for the class being friended.
-// Friend classes do not have access to the "this" pointer of the other class.
\ No newline at end of file
+// Friend classes do not have access to the "this" pointer of the other class.
+
+/***********************
+    INTERNED STRINGS
+***********************/
+
+// Every Person above stores its own copy of firstName and lastName.
+/* Imagine a table of a million people. Thousands of them are named "John", so the text "John" gets stored
+   thousands of times. On top of that, each std::string object is usually 32 bytes, even when empty. */
+/* String INTERNING means storing each distinct string exactly once, in a shared table, and having every
+   object refer to that one copy. */
+// Our InternedString is just a pointer into the table (8 bytes), and it comes with some nice perks:
+// - Two InternedStrings are equal if and only if they point at the same entry, so == compares 2 pointers.
+// - Hashing (ex. for std::unordered_map) just hashes the pointer, no matter how long the string is.
+// - Copying one is as cheap as copying a pointer.
+// The cost is that creating one requires a lookup in the table. So intern a name once, then reuse it.
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+class StringTable {
+    /* Multiple threads may intern names at the same time. One lock for the whole table would make them
+       wait on each other, so the table is split into "shards", each with its own lock. A string always
+       goes in the shard picked by its hash. */
+    struct Shard {
+        std::shared_mutex mutex;
+        // std::deque never moves its elements when it grows, so pointers to them stay valid forever
+        std::deque<std::string> strings;
+        // Looks strings up by string_view, so checking for a name doesn't have to build a std::string
+        std::unordered_map<std::string_view, const std::string*> index;
+    };
+    std::array<Shard, 16> shards;
+
+public:
+    static StringTable& global() {
+        static StringTable table; // Created the first time it's used (thread safe since C++11)
+        return table;
+    }
+
+    const std::string* intern(std::string_view text) {
+        std::size_t hash = std::hash<std::string_view>{}(text);
+        Shard& shard = shards[hash % shards.size()];
+        {
+            std::shared_lock lock(shard.mutex); // Many threads can LOOK at once...
+            auto found = shard.index.find(text);
+            if (found != shard.index.end()) return found->second;
+        }
+        std::unique_lock lock(shard.mutex); // ...but only one can ADD at a time
+        auto found = shard.index.find(text); // Another thread may have added it while we weren't looking
+        if (found != shard.index.end()) return found->second;
+        const std::string& stored = shard.strings.emplace_back(text);
+        shard.index.emplace(stored, &stored); // The key views the stored copy, not the caller's text
+        return &stored;
+    }
+};
+
+class InternedString {
+    const std::string* entry;
+public:
+    InternedString(std::string_view text = "") : entry(StringTable::global().intern(text)) {}
+
+    const std::string& str() const { return *entry; }
+    operator std::string_view() const { return *entry; }
+
+    friend bool operator==(InternedString a, InternedString b) { return a.entry == b.entry; }
+    friend bool operator!=(InternedString a, InternedString b) { return a.entry != b.entry; }
+    // Note: there's no cheap operator<. Sorting alphabetically still needs to compare the actual text.
+
+    friend struct std::hash<InternedString>;
+};
+
+// This lets InternedString be used as a key in std::unordered_map and std::unordered_set
+template <>
+struct std::hash<InternedString> {
+    std::size_t operator()(InternedString s) const noexcept { return std::hash<const void*>{}(s.entry); }
+};
+
+// Our Person class again, this time with interned names:
+
+class Person4 {
+public:
+    InternedString firstName;
+    InternedString lastName;
+    int age = 0;
+
+    Person4(std::string_view firstName, std::string_view lastName, int age)
+        : firstName(firstName), lastName(lastName), age(age) {}
+
+    void sayName() const {
+        std::cout << "I am " << firstName.str() << " " << lastName.str() << "\n";
+    }
+};
+
+// sizeof(Person2) is around 72 bytes. sizeof(Person4) is 24, and the names themselves are only stored once.
+
+void internExample() {
+    Person4 john1("John", "Smith", 30);
+    Person4 john2("John", "Doe", 40);
+    bool sameFirstName = (john1.firstName == john2.firstName); // true, and only compares two pointers
+}
+
+// The strings in the table are never removed, so only intern things that repeat a lot (like names).
+// Interning every unique ID or random string would just be a memory leak with extra steps.
@@ -180,4 +180,388 @@ int* array2 = new int[3]{ 1, 2, 3 };
    is freed upon object destruction. */
 // You can delete any dynamically allocated data members in the class's destructor.
 
+/************************
+    CUSTOM ALLOCATORS
+************************/
+
+// Every "new int" above asks the general-purpose heap for memory.
+/* The heap has to work for any size, any lifetime, and any thread, so each request pays for bookkeeping
+   (and sometimes a lock) that a lot of programs don't actually need. */
+/* If your program makes millions of tiny, short-lived allocations, it can be much faster to grab one big
+   block up front and hand out pieces of it yourself. */
+// C++17 gives us a standard way to plug these "memory resources" into containers: the <memory_resource> header.
+// A memory resource is just a class that derives from std::pmr::memory_resource and overrides 3 functions.
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// A MONOTONIC ARENA hands out memory by bumping a pointer forward through a buffer.
+// Deallocating does nothing. All the memory is given back at once when the arena is released or destroyed.
+// This is perfect for things like "all the allocations made while handling one request".
+/* When the buffer runs out, the arena gets another (twice as big) block from "upstream" and carries on, just
+   like std::pmr::monotonic_buffer_resource. The blocks are kept in a linked list so they can be freed later. */
+
+#include <memory> // For std::align
+
+class ArenaResource : public std::pmr::memory_resource {
+    // Every block starts with one of these, which links it to the block before it
+    struct Block {
+        Block* previous;
+        std::size_t size; // Including this header
+    };
+
+    Block* first = nullptr;   // The oldest block, which release() keeps
+    Block* current = nullptr; // The block we're handing out memory from
+    std::byte* next = nullptr; // The first unused byte in the current block
+    std::byte* end = nullptr;  // One past the end of the current block
+    std::size_t nextBlockSize;
+    std::pmr::memory_resource* upstream;
+
+    // Gets a new block from upstream with room for at least "bytes" bytes at the given alignment
+    void addBlock(std::size_t bytes, std::size_t alignment) {
+        std::size_t size = nextBlockSize;
+        if (size < sizeof(Block) + bytes + alignment) size = sizeof(Block) + bytes + alignment;
+        void* memory = upstream->allocate(size, alignof(Block));
+        current = ::new (memory) Block{current, size};
+        if (!first) first = current;
+        next = reinterpret_cast<std::byte*>(current + 1);
+        end = static_cast<std::byte*>(memory) + size;
+        nextBlockSize = size * 2;
+    }
+public:
+    ArenaResource(std::size_t size, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) {
+        this->upstream = upstream;
+        this->nextBlockSize = size;
+        addBlock(0, 1);
+    }
+    ~ArenaResource() {
+        release();
+        upstream->deallocate(first, first->size, alignof(Block));
+    }
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    // Gives every extra block back to upstream and starts over in the first one
+    // (everything allocated from the arena becomes dangling!)
+    void release() {
+        while (current != first) {
+            Block* previous = current->previous;
+            upstream->deallocate(current, current->size, alignof(Block));
+            current = previous;
+        }
+        next = reinterpret_cast<std::byte*>(first + 1);
+        end = reinterpret_cast<std::byte*>(first) + first->size;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        // std::align moves p forward to the next ADDRESS that's a multiple of alignment, and fails if that
+        // leaves less than "bytes" of space. (Rounding the offset instead would only work if the block itself
+        // happened to be aligned that much.)
+        void* p = next;
+        std::size_t space = end - next;
+        if (!std::align(alignment, bytes, p, space)) { // Out of room, so chain a new block
+            addBlock(bytes, alignment);
+            p = next;
+            space = end - next;
+            std::align(alignment, bytes, p, space); // Can't fail, addBlock() left enough room
+        }
+        next = static_cast<std::byte*>(p) + bytes;
+        return p;
+    }
+    void do_deallocate(void*, std::size_t, std::size_t) override {} // Freed all at once in release()
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// A FIXED-SIZE POOL is for when every allocation has the same size (ex. lots of ints, or lots of nodes).
+/* The pool carves a big block into equally sized "slots". Freed slots are kept in a linked list (called a
+   free list), and the next pointer is stored INSIDE the free slot itself, so it costs no extra memory. */
+// Both allocating and deallocating are just a couple of pointer swaps.
+
+class PoolResource : public std::pmr::memory_resource {
+    struct Slot { Slot* next; };
+
+    std::size_t slotSize;
+    std::size_t slotCount;
+    std::byte* buffer;
+    Slot* freeList = nullptr;
+    std::pmr::memory_resource* upstream;
+public:
+    PoolResource(std::size_t slotSize, std::size_t slotCount,
+                 std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) {
+        // Each slot must be big enough to hold a Slot, and keep every slot aligned
+        if (slotSize < sizeof(Slot)) slotSize = sizeof(Slot);
+        slotSize = (slotSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        this->slotSize = slotSize;
+        this->slotCount = slotCount;
+        this->upstream = upstream;
+        this->buffer = static_cast<std::byte*>(upstream->allocate(slotSize * slotCount));
+
+        // Thread every slot onto the free list
+        for (std::size_t i = slotCount; i > 0; --i) {
+            Slot* slot = reinterpret_cast<Slot*>(buffer + (i - 1) * slotSize);
+            slot->next = freeList;
+            freeList = slot;
+        }
+    }
+    ~PoolResource() { upstream->deallocate(buffer, slotSize * slotCount); }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (bytes > slotSize || alignment > alignof(std::max_align_t) || !freeList) throw std::bad_alloc{};
+        Slot* slot = freeList;
+        freeList = slot->next;
+        return slot;
+    }
+    void do_deallocate(void* p, std::size_t, std::size_t) override {
+        Slot* slot = static_cast<Slot*>(p);
+        slot->next = freeList;
+        freeList = slot;
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Neither of these classes is thread safe. Give each thread its own arena/pool instead of sharing one.
+/* Note: the standard library already ships std::pmr::monotonic_buffer_resource and
+   std::pmr::unsynchronized_pool_resource, which are more complete versions of the two classes above. */
+
+// Here's how you would use them in place of new/delete:
+
+void useCustomAllocators() {
+    ArenaResource arena(1024);
+    int* a = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+    *a = 4;         // Same as "new int{4}", but no trip to the heap
+    arena.release(); // Frees a (and everything else in the arena) at once
+
+    PoolResource pool(sizeof(int), 100);
+    int* b = static_cast<int*>(pool.allocate(sizeof(int), alignof(int)));
+    pool.deallocate(b, sizeof(int), alignof(int)); // Same as "delete b"
+
+    // Any std::pmr container can use them too:
+    ArenaResource arena2(64 * 1024);
+    std::pmr::vector<int> vec(&arena2);
+    vec.push_back(1);
+}
+
+// Don't assume a custom allocator is faster. Always measure it. Here is a simple benchmark:
+
+#include <chrono>
+#include <iostream>
+
+template <typename Func>
+double timeIt(Func func) { // Returns how many milliseconds func took to run
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void benchmarkAllocators() {
+    constexpr int count = 1'000'000;
+    std::vector<int*> ptrs(count);
+
+    double newTime = timeIt([&] {
+        for (int i = 0; i < count; ++i) ptrs[i] = new int{i};
+        for (int i = 0; i < count; ++i) delete ptrs[i];
+    });
+
+    ArenaResource arena(count * sizeof(int));
+    double arenaTime = timeIt([&] {
+        for (int i = 0; i < count; ++i) {
+            ptrs[i] = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+            *ptrs[i] = i;
+        }
+        arena.release();
+    });
+
+    PoolResource pool(sizeof(int), count);
+    double poolTime = timeIt([&] {
+        for (int i = 0; i < count; ++i) {
+            ptrs[i] = static_cast<int*>(pool.allocate(sizeof(int), alignof(int)));
+            *ptrs[i] = i;
+        }
+        for (int i = 0; i < count; ++i) pool.deallocate(ptrs[i], sizeof(int), alignof(int));
+    });
+
+    std::cout << "new/delete: " << newTime << "ms\n";
+    std::cout << "arena:      " << arenaTime << "ms\n";
+    std::cout << "pool:       " << poolTime << "ms\n";
+}
+
+/***************************
+    TRACKING ALLOCATIONS
+***************************/
+
+// The doSomething() example above leaks memory, but nothing in the program tells you that it did.
+/* Tools like Valgrind or a heap profiler can find leaks, but they slow your program down so much that you
+   can't leave them on all the time. */
+/* A cheaper option is to wrap another memory resource in one that counts what goes through it. Since it
+   only adds a few counters per allocation, it can stay on in a real program. */
+
+// We want to know WHERE the memory is being allocated, not just how much.
+/* To do that, each "callsite" (a spot in the code that allocates) gets its own static stats object. A
+   static local variable is only created once, so every pass through the same line shares it. */
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <ostream>
+
+struct CallsiteStats {
+    static constexpr int bucketCount = 16; // Sizes are grouped by power of 2: 1, 2-3, 4-7, ... 32768+
+
+    const char* file;
+    int line;
+    std::atomic<std::size_t> liveBytes{0};
+    std::atomic<std::size_t> peakBytes{0};
+    std::atomic<std::size_t> allocCount{0};
+    std::atomic<std::size_t> sizeHistogram[bucketCount]{};
+    CallsiteStats* next = nullptr; // All callsites are kept in one linked list for the report
+
+    CallsiteStats(const char* file, int line);
+};
+
+// The head of the list. New callsites are pushed onto the front without needing a lock.
+inline std::atomic<CallsiteStats*> allCallsites{nullptr};
+
+inline CallsiteStats::CallsiteStats(const char* file, int line) : file(file), line(line) {
+    next = allCallsites.load();
+    while (!allCallsites.compare_exchange_weak(next, this)) {} // Retry if another thread got there first
+}
+
+// Allocations made outside of any tagged scope get counted here
+inline CallsiteStats unknownCallsite{"(unknown)", 0};
+// The callsite that the current thread is allocating from
+inline thread_local CallsiteStats* currentCallsite = &unknownCallsite;
+
+// Put this at the top of a block to charge every allocation in that block to this line.
+struct CallsiteScope {
+    CallsiteStats* previous;
+    CallsiteScope(CallsiteStats& stats) : previous(currentCallsite) { currentCallsite = &stats; }
+    ~CallsiteScope() { currentCallsite = previous; }
+};
+// The names get the line number pasted on (ex. trackedStats_42), so it can be used more than once per block.
+// ## doesn't expand macros in what it glues, so the extra layer is needed to turn __LINE__ into a number first.
+#define TRACK_CALLSITE() TRACK_CALLSITE_AT(__LINE__)
+#define TRACK_CALLSITE_AT(line) TRACK_CALLSITE_PASTE(line)
+#define TRACK_CALLSITE_PASTE(line) \
+    static CallsiteStats trackedStats_##line{__FILE__, line}; \
+    CallsiteScope trackedScope_##line{trackedStats_##line}
+
+// The resource itself stores a small header in front of every block so it knows which callsite to
+// credit when the block is freed.
+class TrackingResource : public std::pmr::memory_resource {
+    struct Header { CallsiteStats* site; };
+    std::pmr::memory_resource* upstream;
+
+    // The header has to fit in front of the block without breaking the block's alignment
+    static std::size_t headerSpace(std::size_t alignment) {
+        return alignment > sizeof(Header) ? alignment : sizeof(Header);
+    }
+    static int bucketFor(std::size_t bytes) {
+        int bucket = 0;
+        while (bytes > 1 && bucket < CallsiteStats::bucketCount - 1) { bytes >>= 1; ++bucket; }
+        return bucket;
+    }
+public:
+    TrackingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) {
+        this->upstream = upstream;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (alignment < alignof(Header)) alignment = alignof(Header);
+        std::size_t extra = headerSpace(alignment);
+        std::byte* block = static_cast<std::byte*>(upstream->allocate(bytes + extra, alignment));
+        std::byte* user = block + extra;
+
+        CallsiteStats* site = currentCallsite;
+        reinterpret_cast<Header*>(user)[-1].site = site;
+
+        // memory_order_relaxed: we only need each counter to be correct, not ordered with anything else
+        std::size_t live = site->liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::size_t peak = site->peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !site->peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        site->allocCount.fetch_add(1, std::memory_order_relaxed);
+        site->sizeHistogram[bucketFor(bytes)].fetch_add(1, std::memory_order_relaxed);
+        return user;
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        if (alignment < alignof(Header)) alignment = alignof(Header);
+        std::size_t extra = headerSpace(alignment);
+        std::byte* user = static_cast<std::byte*>(p);
+
+        CallsiteStats* site = reinterpret_cast<Header*>(user)[-1].site;
+        site->liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        upstream->deallocate(user - extra, bytes + extra, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Prints one line per callsite. Anything with live bytes left over at exit is probably a leak.
+inline void printAllocationReport(std::ostream& out) {
+    for (CallsiteStats* site = allCallsites.load(); site; site = site->next) {
+        out << site->file << ':' << site->line
+            << "  live=" << site->liveBytes.load() << "B"
+            << "  peak=" << site->peakBytes.load() << "B"
+            << "  allocs=" << site->allocCount.load() << "  sizes:";
+        for (int i = 0; i < CallsiteStats::bucketCount; ++i) {
+            std::size_t n = site->sizeHistogram[i].load();
+            if (n) out << " [" << (std::size_t{1} << i) << "+]=" << n;
+        }
+        out << '\n';
+    }
+}
+
+// Here's how you would use it:
+
+void trackedFunction(TrackingResource& tracker) {
+    TRACK_CALLSITE(); // Everything allocated below is charged to this line
+    std::pmr::vector<int> vec(&tracker);
+    vec.push_back(4);
+
+    TRACK_CALLSITE(); // From here on, allocations are charged to this line instead
+    int* leaked = static_cast<int*>(tracker.allocate(sizeof(int), alignof(int))); // Oops (shows as live)
+    (void)leaked;
+}
+
+// To dump the report when the program exits, register a function with std::atexit().
+/* To dump it on demand, you could also use a signal (ex. "kill -USR1 <pid>" on Linux). However, almost
+   nothing is safe to call inside a signal handler (including std::cout), so the handler should only set a
+   flag that the program checks later. */
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+inline volatile std::sig_atomic_t reportRequested = 0;
+
+void setUpAllocationReports() {
+    std::atexit([] { printAllocationReport(std::cerr); });
+#ifdef SIGUSR1 // Only exists on POSIX systems (Linux, macOS)
+    std::signal(SIGUSR1, [](int) { reportRequested = 1; });
+#endif
+}
+
+// Call this somewhere your program passes through regularly, like the top of a main loop.
+void printReportIfRequested() {
+    if (reportRequested) {
+        reportRequested = 0;
+        printAllocationReport(std::cerr);
+    }
+}
+
 #include "fakeheader.h"
\ No newline at end of file
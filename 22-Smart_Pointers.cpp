@@ -294,4 +294,307 @@ std::shared_ptr<SomeClass> bPtr2{ b };
    to a valid object or not. */
 // The easiest way to test whether a std::weak_ptr is valid is to use the expired() member function.
 
+/*********************************
+    REFERENCE COUNTED POINTERS
+*********************************/
+
+// Our SmartPointer class from the top of this file only supports a single owner.
+// std::shared_ptr supports many owners, but that flexibility has a cost:
+/* 1. Its reference count is atomic, so every copy and destruction is a "locked" CPU instruction, even if
+      your program only has one thread. */
+/* 2. When you don't use std::make_shared(), the count lives in a separate "control block" allocated apart
+      from the object, so touching both usually means two cache misses instead of one. */
+// If you know how your objects will be used, you can write cheaper pointers that share ownership.
+// Here is a small family of them, all built the same way as SmartPointer:
+
+#include <atomic>
+#include <utility>
+
+// 1. rc_ptr: the count and the object are allocated together, and the count is a plain (non-atomic) long.
+//    This is the fastest option, but ONLY use it if all copies stay on one thread.
+// 2. atomic_rc_ptr: the same thing, but the count is a std::atomic<long> so it is safe across threads.
+// Both are the same template. The only difference is the type used for the count.
+
+template <typename T, typename Count>
+class basic_rc_ptr {
+    struct Block {
+        Count refs;
+        T value;
+        template <typename... Args>
+        Block(Args&&... args) : refs(1), value(std::forward<Args>(args)...) {}
+    };
+    Block* block = nullptr;
+
+    // Only make_rc()/make_atomic_rc() can create a new block
+    explicit basic_rc_ptr(Block* block) { this->block = block; }
+    template <typename U, typename C, typename... Args>
+    friend basic_rc_ptr<U, C> make_basic_rc(Args&&... args);
+
+    void release() {
+        // For an atomic count, --refs is an atomic decrement. The last owner deletes the block.
+        if (block && --block->refs == 0) delete block;
+    }
+public:
+    basic_rc_ptr() = default;
+    ~basic_rc_ptr() { release(); }
+
+    // Copying shares ownership, so the count goes up
+    basic_rc_ptr(const basic_rc_ptr& other) {
+        block = other.block;
+        if (block) ++block->refs;
+    }
+    basic_rc_ptr& operator=(const basic_rc_ptr& other) {
+        if (other.block) ++other.block->refs; // Increment first in case other is *this
+        release();
+        block = other.block;
+        return *this;
+    }
+    // Moving transfers ownership, so the count doesn't change at all (no atomic instruction needed)
+    basic_rc_ptr(basic_rc_ptr&& other) noexcept {
+        block = other.block;
+        other.block = nullptr;
+    }
+    basic_rc_ptr& operator=(basic_rc_ptr&& other) noexcept {
+        if (this != &other) {
+            release();
+            block = other.block;
+            other.block = nullptr;
+        }
+        return *this;
+    }
+
+    T& operator*() const { return block->value; }
+    T* operator->() const { return &block->value; }
+    T* get() const { return block ? &block->value : nullptr; }
+    long use_count() const { return block ? static_cast<long>(block->refs) : 0; }
+    explicit operator bool() const { return block != nullptr; }
+};
+
+template <typename T, typename Count, typename... Args>
+basic_rc_ptr<T, Count> make_basic_rc(Args&&... args) {
+    return basic_rc_ptr<T, Count>(new typename basic_rc_ptr<T, Count>::Block(std::forward<Args>(args)...));
+}
+
+template <typename T> using rc_ptr = basic_rc_ptr<T, long>;
+template <typename T> using atomic_rc_ptr = basic_rc_ptr<T, std::atomic<long>>;
+
+template <typename T, typename... Args>
+rc_ptr<T> make_rc(Args&&... args) { return make_basic_rc<T, long>(std::forward<Args>(args)...); }
+template <typename T, typename... Args>
+atomic_rc_ptr<T> make_atomic_rc(Args&&... args) {
+    return make_basic_rc<T, std::atomic<long>>(std::forward<Args>(args)...);
+}
+
+// 3. intrusive_ptr: the count lives INSIDE the object itself, because the class inherits it.
+/* This means the pointer is only as big as a raw pointer, and you can safely make a new intrusive_ptr from
+   a raw pointer at any time (unlike std::shared_ptr, see the bPtr1/bPtr2 example above). */
+// The downside is that you have to change the class to use it.
+// Like basic_rc_ptr, the count's type is a template parameter, so there's a one-thread and a thread-safe one.
+
+template <typename Count>
+class BasicRefCounted {
+    Count refs{0};
+    template <typename T> friend class intrusive_ptr;
+protected:
+    BasicRefCounted() = default;
+    // A copy of an object is a NEW object, so it starts with no owners
+    BasicRefCounted(const BasicRefCounted&) {}
+    BasicRefCounted& operator=(const BasicRefCounted&) { return *this; }
+    virtual ~BasicRefCounted() = default; // Virtual so deleting through a base pointer calls the right one
+};
+
+using RefCounted = BasicRefCounted<long>;                    // ONLY if all the pointers stay on one thread
+using AtomicRefCounted = BasicRefCounted<std::atomic<long>>; // Safe to share across threads
+
+template <typename T>
+class intrusive_ptr {
+    T* ptr = nullptr;
+public:
+    intrusive_ptr(T* ptr = nullptr) {
+        this->ptr = ptr;
+        if (ptr) ++ptr->refs;
+    }
+    ~intrusive_ptr() {
+        if (ptr && --ptr->refs == 0) delete ptr;
+    }
+    intrusive_ptr(const intrusive_ptr& other) : intrusive_ptr(other.ptr) {}
+    intrusive_ptr(intrusive_ptr&& other) noexcept {
+        ptr = other.ptr;
+        other.ptr = nullptr;
+    }
+    // Copy-and-swap: takes the argument by value, so this handles both copy and move assignment
+    intrusive_ptr& operator=(intrusive_ptr other) noexcept {
+        std::swap(ptr, other.ptr);
+        return *this;
+    }
+
+    T& operator*() const { return *ptr; }
+    T* operator->() const { return ptr; }
+    T* get() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+};
+
+class Node : public RefCounted { // To use intrusive_ptr, a class inherits the count
+public:
+    int value = 0;
+};
+
+void refCountedExamples() {
+    rc_ptr<Fraction> f1 = make_rc<Fraction>(3, 5);
+    rc_ptr<Fraction> f2 = f1;                  // f1.use_count() is now 2
+    atomic_rc_ptr<Fraction> f3 = make_atomic_rc<Fraction>(1, 2); // Safe to copy from multiple threads
+
+    intrusive_ptr<Node> n1{ new Node{} };
+    intrusive_ptr<Node> n2{ n1.get() };        // Fine! The count is in the object, so n1 and n2 agree
+}
+
+// As always, measure before you switch. Here is a microbenchmark of copy, move, and destroy:
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+template <typename Ptr>
+void benchmarkPointer(const char* name, Ptr original) {
+    constexpr int count = 1'000'000;
+    std::vector<Ptr> copies;
+    copies.reserve(count);
+    std::vector<Ptr> moved;
+    moved.reserve(count);
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    for (int i = 0; i < count; ++i) copies.push_back(original);           // Copy: count goes up
+    auto afterCopy = Clock::now();
+    for (int i = 0; i < count; ++i) moved.push_back(std::move(copies[i])); // Move: count untouched
+    auto afterMove = Clock::now();
+    moved.clear();                                                         // Destroy: count goes down
+    auto afterDestroy = Clock::now();
+
+    auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+    std::cout << name << ": copy " << ms(afterCopy - start) << "ms, move " << ms(afterMove - afterCopy)
+              << "ms, destroy " << ms(afterDestroy - afterMove) << "ms\n";
+}
+
+void benchmarkRefCountedPointers() {
+    benchmarkPointer("std::shared_ptr", std::make_shared<Fraction>(1, 2));
+    benchmarkPointer("rc_ptr         ", make_rc<Fraction>(1, 2));
+    benchmarkPointer("atomic_rc_ptr  ", make_atomic_rc<Fraction>(1, 2));
+    benchmarkPointer("intrusive_ptr  ", intrusive_ptr<Node>{ new Node{} });
+}
+
+/***********************
+    POOLED FACTORIES
+***********************/
+
+// std::make_unique<Fraction>(3, 5) allocates a new Fraction on the heap every time it's called.
+/* If your program constantly creates and destroys the same type of small object, most of that heap work is
+   wasted: you free a Fraction-sized block, and a moment later you ask for another Fraction-sized block. */
+// Instead, we can keep the freed blocks around in a pool and hand them out again.
+// Both std::unique_ptr and std::shared_ptr let us pass a custom DELETER, which runs instead of "delete".
+// Our deleter will destroy the object, then put its memory back in the pool instead of freeing it.
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+template <typename T>
+class ObjectPool {
+    // A free block is reused to store the pointer to the next free block
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+    Slot* freeList = nullptr;
+    std::size_t freeCount = 0;
+    static constexpr std::size_t maxFree = 4096; // Past this, just give memory back to the heap
+
+    // Each thread gets its own pool, so no locks are needed
+    static ObjectPool& local() {
+        thread_local ObjectPool pool;
+        return pool;
+    }
+    /* A thread's pool is destroyed when the thread exits, but a pooled object can outlive it: for example, a
+       static that holds one is destroyed at the very end of the program, after main()'s pool is gone. Using
+       a destroyed pool is undefined behavior, so this flag remembers it. (A bool has no destructor, so it's
+       still safe to read at that point.) */
+    static inline thread_local bool poolDestroyed = false;
+
+    ~ObjectPool() {
+        poolDestroyed = true;
+        while (freeList) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            delete slot;
+        }
+    }
+
+public:
+    // Both of these use the calling thread's pool. Once it's gone, they fall back to plain new and delete.
+    static void* allocate() {
+        if (poolDestroyed) return new Slot;
+        ObjectPool& pool = local();
+        if (!pool.freeList) return new Slot;
+        Slot* slot = pool.freeList;
+        pool.freeList = slot->next;
+        --pool.freeCount;
+        return slot;
+    }
+    static void deallocate(void* p) {
+        Slot* slot = static_cast<Slot*>(p);
+        if (poolDestroyed) { delete slot; return; }
+        ObjectPool& pool = local();
+        if (pool.freeCount == maxFree) { delete slot; return; }
+        slot->next = pool.freeList;
+        pool.freeList = slot;
+        ++pool.freeCount;
+    }
+};
+
+/* Every block is its own "new Slot", so it doesn't matter which thread's pool it goes back to. An object
+   created on one thread and destroyed on another simply moves to the second thread's pool. */
+
+template <typename T>
+struct PoolDeleter {
+    void operator()(T* ptr) const {
+        ptr->~T(); // Run the destructor without freeing the memory
+        ObjectPool<T>::deallocate(ptr);
+    }
+};
+
+template <typename T>
+using pooled_unique_ptr = std::unique_ptr<T, PoolDeleter<T>>;
+
+template <typename T, typename... Args>
+pooled_unique_ptr<T> make_pooled_unique(Args&&... args) {
+    void* memory = ObjectPool<T>::allocate();
+    try {
+        return pooled_unique_ptr<T>(new (memory) T(std::forward<Args>(args)...)); // "Placement new"
+    } catch (...) {
+        ObjectPool<T>::deallocate(memory); // Don't lose the block if the constructor throws
+        throw;
+    }
+}
+
+// A std::shared_ptr can take ownership from a std::unique_ptr, deleter included.
+/* Note that std::shared_ptr still allocates its control block on the heap. Only std::make_shared() avoids
+   that, and it doesn't accept a custom deleter. */
+
+template <typename T, typename... Args>
+std::shared_ptr<T> make_pooled_shared(Args&&... args) {
+    return std::shared_ptr<T>(make_pooled_unique<T>(std::forward<Args>(args)...));
+}
+
+// Usage is the same as std::make_unique() and std::make_shared():
+
+void pooledFactoryExamples() {
+    auto frac1 = make_pooled_unique<Fraction>(3, 5);
+    frac1.reset(); // frac1's memory goes back into the pool...
+    auto frac2 = make_pooled_unique<Fraction>(1, 2); // ...and gets reused here. No heap allocation!
+
+    std::shared_ptr<Fraction> frac3 = make_pooled_shared<Fraction>(2, 3);
+}
+
 #include "fakeheader"
\ No newline at end of file
@@ -359,4 +359,453 @@ if (d) { // Makes sure d is not null
 // Because RTTI has a pretty significant space performance cost, some compilers allow you to turn it off.
 // Needless to say, if you do this, dynamic_cast won’t function correctly.
 
+/*****************************
+    POLYMORPHIC CONTAINERS
+*****************************/
+
+// The object slicing section above says to store pointers if you want a vector of polymorphic objects.
+/* That works, but each object is its own heap allocation, so they end up scattered all over memory. Looping
+   over them means jumping around in memory (slow), and the CPU can't predict which version of a virtual
+   function comes next, since a Circle might be followed by a Square, then another Circle... */
+/* A faster layout is to give each derived type its own std::vector. Objects of the same type sit next to
+   each other in memory, and we loop over them one type at a time. */
+// This way the same virtual function gets called over and over, which the CPU predicts almost perfectly.
+// And if we tell the compiler the exact type, it can skip the virtual call altogether (devirtualization).
+
+// Let's redo our shapes so that they actually have a virtual function to call:
+
+class Shape {
+public:
+    virtual ~Shape() = default;
+    virtual double area() const = 0;
+    virtual double perimeter() const = 0;
+};
+
+// "final" means nothing can inherit from these, so when the compiler knows it has a Circle, it knows
+// exactly which area() to call.
+class Circle final : public Shape {
+    double radius;
+public:
+    Circle(double radius = 1) { this->radius = radius; }
+    double area() const override { return 3.14159265358979 * radius * radius; }
+    double perimeter() const override { return 2 * 3.14159265358979 * radius; }
+};
+
+class Triangle final : public Shape { // Equilateral, to keep things simple
+    double side;
+public:
+    Triangle(double side = 1) { this->side = side; }
+    double area() const override { return 0.43301270189 * side * side; } // (sqrt(3) / 4) * side^2
+    double perimeter() const override { return 3 * side; }
+};
+
+class Square final : public Shape {
+    double side;
+public:
+    Square(double side = 1) { this->side = side; }
+    double area() const override { return side * side; }
+    double perimeter() const override { return 4 * side; }
+};
+
+class Rectangle final : public Shape {
+    double width, height;
+public:
+    Rectangle(double width = 1, double height = 1) { this->width = width; this->height = height; }
+    double area() const override { return width * height; }
+    double perimeter() const override { return 2 * (width + height); }
+};
+
+// Now here's the container. Each "segment" is a std::vector holding one derived type.
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename Base>
+class PolyCollection {
+    struct SegmentBase {
+        const void* typeTag;
+        virtual ~SegmentBase() = default;
+        virtual std::size_t size() const = 0;
+        // Calls "call(context, element)" for every element. Note this doesn't save any calls: forEach() pays
+        // for this indirect call AND the virtual call inside it for every element. What it does win is that
+        // the elements sit next to each other in memory, and both calls go to the same place for a whole
+        // segment, so the CPU predicts them perfectly. forEachOf() below gets rid of both calls.
+        virtual void visit(void* context, void (*call)(void*, Base&)) = 0;
+    };
+
+    template <typename T>
+    struct Segment : SegmentBase {
+        std::vector<T> items;
+        std::size_t size() const override { return items.size(); }
+        void visit(void* context, void (*call)(void*, Base&)) override {
+            for (T& item : items) call(context, item);
+        }
+    };
+
+    std::vector<std::unique_ptr<SegmentBase>> segments;
+
+    // Every type T gets its own static variable, so its address works as a unique ID for that type
+    template <typename T>
+    static const void* typeTag() {
+        static const char tag{};
+        return &tag;
+    }
+
+    template <typename T>
+    Segment<T>* findSegment() {
+        for (auto& segment : segments) {
+            if (segment->typeTag == typeTag<T>()) return static_cast<Segment<T>*>(segment.get());
+        }
+        return nullptr;
+    }
+
+public:
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        static_assert(std::is_base_of_v<Base, T>, "T must derive from Base");
+        Segment<T>* segment = findSegment<T>();
+        if (!segment) {
+            auto created = std::make_unique<Segment<T>>();
+            created->typeTag = typeTag<T>();
+            segment = created.get();
+            segments.push_back(std::move(created));
+        }
+        return segment->items.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void insert(T value) { emplace<T>(std::move(value)); }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (auto& segment : segments) total += segment->size();
+        return total;
+    }
+
+    // Visit every element as a Base&, one type at a time. Works even for types you don't list anywhere.
+    template <typename Func>
+    void forEach(Func func) {
+        for (auto& segment : segments) {
+            segment->visit(&func, [](void* context, Base& item) { (*static_cast<Func*>(context))(item); });
+        }
+    }
+
+    // Visit only the listed types, as their real type. Here the compiler knows exactly which class it has,
+    // so calls to final/non-virtual functions don't need the vtable at all.
+    template <typename... Ts, typename Func>
+    void forEachOf(Func func) {
+        auto visitType = [&](auto* typeHint) {
+            using T = std::remove_pointer_t<decltype(typeHint)>;
+            if (Segment<T>* segment = findSegment<T>()) {
+                for (T& item : segment->items) func(item);
+            }
+        };
+        (visitType(static_cast<Ts*>(nullptr)), ...);
+    }
+};
+
+// Note that PolyCollection does NOT keep the order you inserted things in, since all the Circles are
+// grouped together, then all the Squares, etc.
+// Also, like any std::vector, inserting may move elements, so don't hold on to pointers to them.
+
+void polyCollectionExample() {
+    PolyCollection<Shape> shapes;
+    shapes.emplace<Circle>(2.0);
+    shapes.emplace<Square>(3.0);
+    shapes.insert(Rectangle{2.0, 4.0});
+
+    double total = 0;
+    shapes.forEach([&](const Shape& shape) { total += shape.area(); });
+    shapes.forEachOf<Circle, Triangle, Square, Rectangle>([&](const auto& shape) { total += shape.area(); });
+}
+
+// Here is a benchmark against the usual vector of pointers:
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// Both benchmarks in this file use this. It returns how many milliseconds func() took.
+template <typename Func>
+double timeIt(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void benchmarkPolyCollection() {
+    constexpr int count = 2'000'000;
+    std::mt19937 mt{42};
+
+    std::vector<std::unique_ptr<Shape>> pointers;
+    PolyCollection<Shape> collection;
+    for (int i = 0; i < count; ++i) {
+        double size = mt() % 100 + 1;
+        switch (i % 4) {
+        case 0: pointers.push_back(std::make_unique<Circle>(size)); collection.emplace<Circle>(size); break;
+        case 1: pointers.push_back(std::make_unique<Triangle>(size)); collection.emplace<Triangle>(size); break;
+        case 2: pointers.push_back(std::make_unique<Square>(size)); collection.emplace<Square>(size); break;
+        case 3:
+            pointers.push_back(std::make_unique<Rectangle>(size, 2));
+            collection.emplace<Rectangle>(size, 2);
+            break;
+        }
+    }
+    std::shuffle(pointers.begin(), pointers.end(), mt); // Real programs rarely create objects in a neat order
+
+    double total = 0; // Printed too, so the compiler can't skip the area() calls
+    std::cout << "vector<unique_ptr<Shape>>: " << timeIt([&] {
+        for (const auto& shape : pointers) total += shape->area();
+    }) << "ms (total area " << total << ")\n";
+    total = 0;
+    std::cout << "PolyCollection::forEach:   " << timeIt([&] {
+        collection.forEach([&](const Shape& shape) { total += shape.area(); });
+    }) << "ms (total area " << total << ")\n";
+    total = 0;
+    auto addArea = [&](const auto& shape) { total += shape.area(); };
+    std::cout << "PolyCollection::forEachOf: " << timeIt([&] {
+        collection.forEachOf<Circle, Triangle, Square, Rectangle>(addArea);
+    }) << "ms (total area " << total << ")\n";
+}
+
+/***********************
+    VARIANT DISPATCH
+***********************/
+
+// Virtual functions are great when anyone might add a new derived class later.
+/* But sometimes you know the complete list of derived classes ahead of time, like our Circle, Triangle,
+   Square, and Rectangle. In that case, C++17's std::variant can replace the Shape pointer entirely. */
+// A std::variant holds exactly one of a fixed list of types, stored directly inside the variant itself.
+// There is no heap allocation and no pointer to follow, so a std::vector of them is one contiguous block.
+/* std::visit calls the right function for whatever type the variant currently holds. It does this with a
+   jump table built at compile time, indexed by which type is stored. Since our shapes are "final", each
+   entry calls area() directly instead of going through the vtable. */
+
+#include <variant>
+
+class AnyShape {
+    std::variant<Circle, Triangle, Square, Rectangle> shape;
+
+    template <typename T>
+    static constexpr bool isShapeType = std::is_same_v<T, Circle> || std::is_same_v<T, Triangle> ||
+                                        std::is_same_v<T, Square> || std::is_same_v<T, Rectangle>;
+public:
+    // Not explicit, so a Circle converts to an AnyShape automatically, just like a Circle* converts to Shape*
+    // std::enable_if_t removes this constructor for anything but the 4 shape types, so passing anything else
+    // gives a short "no matching constructor" error, instead of a page of errors from inside std::variant.
+    template <typename T, typename = std::enable_if_t<isShapeType<T>>>
+    AnyShape(T shape) : shape(std::move(shape)) {}
+
+    // The same functions as Shape, so code written for one works with the other
+    double area() const { return std::visit([](const auto& s) { return s.area(); }, shape); }
+    double perimeter() const { return std::visit([](const auto& s) { return s.perimeter(); }, shape); }
+
+    // Lets call sites written for Shape pointers ("shape->area()") compile unchanged
+    const AnyShape* operator->() const { return this; }
+
+    // For code that really does need a Shape& (ex. an existing function that takes one)
+    const Shape& asShape() const { return std::visit([](const auto& s) -> const Shape& { return s; }, shape); }
+
+    // Like dynamic_cast, returns nullptr if this isn't actually a T
+    template <typename T>
+    const T* getIf() const { return std::get_if<T>(&shape); }
+};
+
+// Because both versions have the same interface, a template can be written once for both of them:
+
+#include <memory>
+#include <vector>
+
+template <typename ShapeList>
+double totalArea(const ShapeList& shapes) {
+    double total = 0;
+    for (const auto& shape : shapes) total += shape->area();
+    return total;
+}
+
+void variantDispatchExample() {
+    std::vector<std::unique_ptr<Shape>> pointerShapes;
+    pointerShapes.push_back(std::make_unique<Circle>(2.0));
+    pointerShapes.push_back(std::make_unique<Square>(3.0));
+
+    std::vector<AnyShape> valueShapes;
+    valueShapes.push_back(Circle{2.0});
+    valueShapes.push_back(Square{3.0});
+
+    double a = totalArea(pointerShapes); // Virtual calls through pointers
+    double b = totalArea(valueShapes);   // Jump table over values stored in place
+}
+
+// The downsides:
+// 1. Adding a new shape means editing the variant's type list (and recompiling everything that uses it).
+// 2. Every AnyShape is as big as the LARGEST type in the list, plus a small index.
+/* 3. Our shapes still inherit from Shape, so each one still carries a vtable pointer. If you never need the
+      Shape& version, you can drop the base class and the virtual keyword to make them smaller. */
+
+/*******************
+    FAST CASTING
+*******************/
+
+/* As mentioned above, dynamic_cast needs RTTI, and it can be slow. To check a cast, it has to walk the
+   class's inheritance information at runtime (often including comparing type names as strings). */
+// If you downcast in a hot loop, or turn RTTI off with -fno-rtti, you can do the checking yourself.
+/* The trick is to give every class in the hierarchy a number (a "kind"), and store that number in the base
+   class. Then checking a cast is just comparing numbers. LLVM does this throughout its codebase. */
+
+// If the numbers are assigned in "depth-first" order, every class and all of its children get a
+// continuous range of numbers. Here, Derived and everything below it falls in [Derived, LastDerived]:
+
+//   Base             0
+//     Derived        1   <- Derived's range is 1 to 2
+//       MoreDerived  2
+//     Other          3
+
+#include <type_traits>
+
+class Base {
+public:
+    enum class Kind : unsigned { Base, Derived, MoreDerived, LastDerived = MoreDerived, Other };
+
+    virtual ~Base() = default;
+    Kind getKind() const { return kind; }
+    Base() : kind(Kind::Base) {}
+    static bool classof(const Base*) { return true; } // Everything is a Base
+
+protected:
+    Base(Kind kind) : kind(kind) {} // Each derived class passes its own kind in
+private:
+    const Kind kind;
+};
+
+// Checks first <= kind <= last with a single comparison. If kind < first, the unsigned subtraction wraps
+// around to a huge number, which fails the check too.
+template <typename Kind>
+constexpr bool kindInRange(Kind kind, Kind first, Kind last) {
+    using U = std::underlying_type_t<Kind>;
+    return static_cast<U>(static_cast<U>(kind) - static_cast<U>(first))
+           <= static_cast<U>(static_cast<U>(last) - static_cast<U>(first));
+}
+
+class Derived : public Base {
+public:
+    Derived() : Base(Kind::Derived) {}
+    static bool classof(const Base* b) { return kindInRange(b->getKind(), Kind::Derived, Kind::LastDerived); }
+protected:
+    Derived(Kind kind) : Base(kind) {} // So classes below Derived can pass their kind through
+};
+
+class MoreDerived : public Derived {
+public:
+    MoreDerived() : Derived(Kind::MoreDerived) {}
+    static bool classof(const Base* b) { return b->getKind() == Kind::MoreDerived; } // No children
+};
+
+class Other : public Base {
+public:
+    Other() : Base(Kind::Other) {}
+    static bool classof(const Base* b) { return b->getKind() == Kind::Other; }
+};
+
+// fast_cast works just like dynamic_cast<To*>: it returns nullptr if the object isn't actually a To.
+// After the check passes, static_cast does the actual conversion (which is free, or adds an offset).
+
+template <typename To, typename From>
+auto fast_cast(From* ptr) -> std::conditional_t<std::is_const_v<From>, const To*, To*> {
+    if (ptr && To::classof(ptr)) return static_cast<std::conditional_t<std::is_const_v<From>, const To*, To*>>(ptr);
+    return nullptr;
+}
+
+Base* b2{getObject(true)};
+Derived* d2{fast_cast<Derived>(b2)}; // Same as dynamic_cast<Derived*>(b2), but just a number check
+
+// This also works with multiple inheritance, as long as each base class has its own kind.
+/* A Teacher is both a Person and an Employee, so it sets the kind in both parts, and provides a classof()
+   for each base class. static_cast knows where the Person and Employee parts sit inside a Teacher, so it
+   adjusts the pointer correctly. */
+
+class Person {
+public:
+    enum class Kind : unsigned { Person, Student, Teacher };
+    virtual ~Person() = default;
+    Kind getPersonKind() const { return kind; }
+    Person() : kind(Kind::Person) {}
+protected:
+    Person(Kind kind) : kind(kind) {}
+private:
+    const Kind kind;
+};
+
+class Employee {
+public:
+    enum class Kind : unsigned { Employee, Teacher, Janitor };
+    virtual ~Employee() = default;
+    Kind getEmployeeKind() const { return kind; }
+    Employee() : kind(Kind::Employee) {}
+protected:
+    Employee(Kind kind) : kind(kind) {}
+private:
+    const Kind kind;
+};
+
+class Teacher : public Person, public Employee {
+public:
+    Teacher() : Person(Person::Kind::Teacher), Employee(Employee::Kind::Teacher) {}
+    static bool classof(const Person* p) { return p->getPersonKind() == Person::Kind::Teacher; }
+    static bool classof(const Employee* e) { return e->getEmployeeKind() == Employee::Kind::Teacher; }
+};
+
+// One limitation: unlike dynamic_cast, this can't "cross cast" from a Person* straight to an Employee*.
+// You'd have to fast_cast to Teacher first.
+// Another: you have to keep the Kind list up to date yourself whenever you add a class.
+
+// Here is a benchmark against dynamic_cast. It only builds when RTTI is turned on, since dynamic_cast
+// won't work otherwise.
+
+#if defined(__GXX_RTTI) || defined(_CPPRTTI) // Compiler flags that mean RTTI is on (GCC/Clang and MSVC)
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+void benchmarkCasts() {
+    constexpr int count = 3'000'000;
+    std::vector<std::unique_ptr<Base>> objects;
+    std::vector<std::unique_ptr<Employee>> employees;
+    for (int i = 0; i < count; ++i) {
+        switch (i % 3) { // A random order would be more realistic, but this keeps things simple
+        case 0: objects.push_back(std::make_unique<Derived>()); break;
+        case 1: objects.push_back(std::make_unique<MoreDerived>()); break;
+        case 2: objects.push_back(std::make_unique<Other>()); break;
+        }
+        if (i % 2) employees.push_back(std::make_unique<Teacher>());
+        else employees.push_back(std::make_unique<Employee>());
+    }
+
+    int hits = 0; // Printed too, so the compiler can't skip the casts
+
+    // Deep hierarchy: casting to a class in the middle of the tree
+    std::cout << "dynamic_cast<Derived*>:       " << timeIt([&] {
+        for (auto& object : objects) hits += dynamic_cast<Derived*>(object.get()) != nullptr;
+    }) << "ms (" << hits << " succeeded)\n";
+    hits = 0;
+    std::cout << "fast_cast<Derived>:           " << timeIt([&] {
+        for (auto& object : objects) hits += fast_cast<Derived>(object.get()) != nullptr;
+    }) << "ms (" << hits << " succeeded)\n";
+
+    // Multiple inheritance: Employee* -> Teacher* (the pointer has to be adjusted)
+    hits = 0;
+    std::cout << "dynamic_cast<Teacher*>:       " << timeIt([&] {
+        for (auto& employee : employees) hits += dynamic_cast<Teacher*>(employee.get()) != nullptr;
+    }) << "ms (" << hits << " succeeded)\n";
+    hits = 0;
+    std::cout << "fast_cast<Teacher>:           " << timeIt([&] {
+        for (auto& employee : employees) hits += fast_cast<Teacher>(employee.get()) != nullptr;
+    }) << "ms (" << hits << " succeeded)\n";
+}
+#endif
+
 #include "fakeheader.h"
\ No newline at end of file